@@ -8,6 +8,7 @@
 //---------------------------------------------------------------------------
 
 #include <vector>
+#include <math.h>
 #include <fstream>
 #include <iostream>
 #include "PerspectiveTransform.h"
@@ -212,36 +213,33 @@ PerspectiveTransform PerspectiveTransform::squareToQuadrilateral(
   return result;
 }
 
+/*
+ * This function transforms a single point using the PerspectiveTransform
+ * object's matrix values, with the same formulas as transformPoints.
+ */
+void PerspectiveTransform::transformPoint(double x, double y,
+                                          double &newX, double &newY) const
+{
+  double denominator = a13 * x + a23 * y + a33;
+  newX = (a11 * x + a21 * y + a31) / denominator;
+  newY = (a12 * x + a22 * y + a32) / denominator;
+}
+
 /*
  * This function transforms the points of a given pixel array using the
  * PerspectiveTransform object's matrix values. The returned object is a
  * new pixel array containing the transformed image.
  */
-int** PerspectiveTransform::transformPoints(int** givenPixelArray, 
-                                            int givenWidth, 
-                                            int givenHeight)
+std::vector<int> PerspectiveTransform::transformPoints(
+                                const std::vector<int> &givenPixelArray,
+                                int givenWidth, int givenHeight)
 {
 
   /*
-   * Creates a new pixel array with the same 
-   * width and height of the given pixel array.
+   * Creates a new pixel array with the same width and height of the
+   * given pixel array. Its default form is a blank white image.
    */
-  int** imgPixelArray = new int*[givenHeight];
-  for(int dynamicIndex = 0; dynamicIndex < givenHeight; ++dynamicIndex)
-  {
-    imgPixelArray[dynamicIndex] = new int[givenWidth];
-  }
-
-  /*
-   * The new pixel array's default form is a blank white image.
-   */
-  for (int heightIndex=0; heightIndex<givenHeight; ++heightIndex)
-  {
-    for (int widthIndex=0; widthIndex<givenWidth; ++widthIndex)
-    {
-      imgPixelArray[heightIndex][widthIndex] = 1;
-    }
-  }
+  std::vector<int> imgPixelArray(givenWidth * givenHeight, 1);
   
   /*
    * Each pixel in the given pixel array is 
@@ -270,6 +268,16 @@ int** PerspectiveTransform::transformPoints(int** givenPixelArray,
       double doubleNewX = ((a11 * x + a21 * y + a31) / denominator);
       double doubleNewY = ((a12 * x + a22 * y + a32) / denominator);
       
+      /*
+       * Points sent to infinity (or nowhere, when the denominator is 0)
+       * cannot be converted to an integer and are ignored.
+       */
+      if (!(fabs(doubleNewX) < givenWidth + 1.0) ||
+          !(fabs(doubleNewY) < givenHeight + 1.0))
+      {
+        continue;
+      }
+      
       /*
        * Since the pixel array does not have any decimal coordinates,
        * the new coordinate is converted into an integer.
@@ -282,14 +290,14 @@ int** PerspectiveTransform::transformPoints(int** givenPixelArray,
        * of bounds of the avaliable size of the image. Thus, new coordinates
        * that are out of bounds would be ignored.
        */
-      int value = givenPixelArray[heightIndex][widthIndex];
-      if(newX < givenWidth && newY < givenHeight && newX > 0 && newY > 0)
+      int value = givenPixelArray[heightIndex * givenWidth + widthIndex];
+      if(newX < givenWidth && newY < givenHeight && newX >= 0 && newY >= 0)
       {
         /*
          * The pixel value of the given pixel array is then 
          * stored in the new pixel array at its new coordinates.
          */
-        imgPixelArray[newY][newX] = value;
+        imgPixelArray[newY * givenWidth + newX] = value;
       }
     }
   }    
@@ -306,7 +314,7 @@ int** PerspectiveTransform::transformPoints(int** givenPixelArray,
     {
       for (int widthIndex=0; widthIndex<givenWidth; ++widthIndex)
       {
-        myfile << imgPixelArray[heightIndex][widthIndex] << " ";
+        myfile << imgPixelArray[heightIndex * givenWidth + widthIndex] << " ";
       }
       myfile << "\n";
     }    
@@ -7,6 +7,9 @@
 //
 //---------------------------------------------------------------------------
 
+#ifndef PERSPECTIVETRANSFORM_H
+#define PERSPECTIVETRANSFORM_H
+
 #include <vector>
 
 class PerspectiveTransform{
@@ -35,5 +38,19 @@ class PerspectiveTransform{
       double x3, double y3
     );
     
-    int** transformPoints(int** givenPixelArray, int givenWidth, int givenHeight);      
+    /*
+     * Maps a single point, for callers that sample the source image at
+     * the point each target pixel comes from.
+     */
+    void transformPoint(double x, double y,
+                        double &newX, double &newY) const;
+    
+    /*
+     * The pixel arrays are givenWidth x givenHeight values stored row by
+     * row, and the result is returned by value so nothing is left to free.
+     */
+    std::vector<int> transformPoints(const std::vector<int> &givenPixelArray,
+                                     int givenWidth, int givenHeight);      
 };
+
+#endif
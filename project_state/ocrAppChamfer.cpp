@@ -0,0 +1,137 @@
+/***************************************************************
+ * Name:      ocrAppChamfer.cpp
+ * Purpose:   Code for Distance Transforms and Chamfer Matching
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppChamfer.h"
+
+//Functions
+bool is_black(const uint64_t bits[], int p);
+int edge_cost(const vector<int> &edges, const vector<unsigned char> &dist);
+
+/*
+* An edge pixel is a black pixel next to a white pixel or to the border.
+* The distance map holds for every pixel its distance to the nearest edge
+* pixel, computed with the 3-4 chamfer approximation of the Euclidean
+* distance in one forward and one backward pass.
+*/
+void chamfer_model(const uint64_t bits[], int width, int height,
+    ChamferModel &model)
+{
+    int numPixels = width * height;
+    vector<int> dist(numPixels);
+    model.edges.clear();
+
+    //Edge Detection
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int p = y * width + x;
+            bool edge = is_black(bits, p) &&
+                (x == 0 || y == 0 || x == width - 1 || y == height - 1 ||
+                 !is_black(bits, p - 1) || !is_black(bits, p + 1) ||
+                 !is_black(bits, p - width) || !is_black(bits, p + width));
+            if (edge)
+                model.edges.push_back(p);
+            dist[p] = edge ? 0 : CHAMFER_CAP;
+        }
+    }
+
+    //Forward Pass
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int p = y * width + x;
+            int d = dist[p];
+            if (x > 0 && dist[p-1] + CHAMFER_STRAIGHT < d)
+                d = dist[p-1] + CHAMFER_STRAIGHT;
+            if (y > 0)
+            {
+                if (dist[p-width] + CHAMFER_STRAIGHT < d)
+                    d = dist[p-width] + CHAMFER_STRAIGHT;
+                if (x > 0 && dist[p-width-1] + CHAMFER_DIAGONAL < d)
+                    d = dist[p-width-1] + CHAMFER_DIAGONAL;
+                if (x < width - 1 && dist[p-width+1] + CHAMFER_DIAGONAL < d)
+                    d = dist[p-width+1] + CHAMFER_DIAGONAL;
+            }
+            dist[p] = d;
+        }
+    }
+
+    //Backward Pass
+    for (int y = height - 1; y >= 0; y--)
+    {
+        for (int x = width - 1; x >= 0; x--)
+        {
+            int p = y * width + x;
+            int d = dist[p];
+            if (x < width - 1 && dist[p+1] + CHAMFER_STRAIGHT < d)
+                d = dist[p+1] + CHAMFER_STRAIGHT;
+            if (y < height - 1)
+            {
+                if (dist[p+width] + CHAMFER_STRAIGHT < d)
+                    d = dist[p+width] + CHAMFER_STRAIGHT;
+                if (x < width - 1 && dist[p+width+1] + CHAMFER_DIAGONAL < d)
+                    d = dist[p+width+1] + CHAMFER_DIAGONAL;
+                if (x > 0 && dist[p+width-1] + CHAMFER_DIAGONAL < d)
+                    d = dist[p+width-1] + CHAMFER_DIAGONAL;
+            }
+            dist[p] = d;
+        }
+    }
+
+    model.dist.assign(dist.begin(), dist.end());
+}
+
+/*
+* Chamfer Matching
+* The cost of a glyph against a template is the average distance from the
+* glyph's edge pixels to the template's edges, so a stroke that is off by
+* one pixel costs 3 instead of failing every pixel comparison along it.
+* The same is done from the template's edges to the glyph, so that a
+* glyph that is only part of a template (F against E) is not a perfect
+* fit. Both are sums over edge pixels only, a few hundred lookups per
+* template instead of a comparison of every pixel.
+*/
+void chamfer_scores(const ChamferModel &glyph,
+    const ChamferModel templates[], int numTemplates, int numPixels,
+    int stat[])
+{
+    for (int i = 0; i < numTemplates; i++)
+    {
+        const ChamferModel &temp = templates[i];
+        if (glyph.edges.empty() || temp.edges.empty())
+        {
+            stat[i] = 0;
+            continue;
+        }
+
+        //Average of the Two Directions, in Steps of 1/numPixels
+        long long forward = edge_cost(glyph.edges, temp.dist);
+        long long backward = edge_cost(temp.edges, glyph.dist);
+        long long cost = forward * numPixels / (long long)glyph.edges.size()
+            + backward * numPixels / (long long)temp.edges.size();
+        stat[i] = numPixels - (int)(cost / (2 * CHAMFER_CAP));
+    }
+}
+
+//Supplementary Code
+bool is_black(const uint64_t bits[], int p)
+{
+    return (bits[p >> 6] >> (p & 63)) & 1;
+}
+
+int edge_cost(const vector<int> &edges, const vector<unsigned char> &dist)
+{
+    int sum = 0;
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        sum += dist[edges[e]];
+    }
+    return sum;
+}
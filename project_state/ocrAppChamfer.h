@@ -0,0 +1,39 @@
+/***************************************************************
+ * Name:      ocrAppChamfer.h
+ * Purpose:   Defines Distance Transforms and Chamfer Matching
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPCHAMFER_H
+#define OCRAPPCHAMFER_H
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+//Definitions
+#define CHAMFER_STRAIGHT 3 //Distance of a horizontal or vertical step
+#define CHAMFER_DIAGONAL 4 //Distance of a diagonal step
+#define CHAMFER_CAP 24     //Distances are clipped at 8 pixels
+
+//Edges and distance map of a glyph or a template
+struct ChamferModel
+{
+    vector<unsigned char> dist; //Distance to the nearest edge pixel
+    vector<int> edges;          //Index (y*width + x) of every edge pixel
+};
+
+//Chamfer Functions
+//Builds the model of a packed image (see pack_bits)
+void chamfer_model(const uint64_t bits[], int width, int height,
+    ChamferModel &model);
+//Scores a glyph against every template, scaled like match_scores so
+//that a perfect fit gives numPixels and a distant one gives 0
+void chamfer_scores(const ChamferModel &glyph,
+    const ChamferModel templates[], int numTemplates, int numPixels,
+    int stat[]);
+
+#endif
@@ -0,0 +1,288 @@
+/***************************************************************
+ * Name:      ocrAppDecode.cpp
+ * Purpose:   Code for Plate Grammars and Format-Constrained Decoding
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppDecode.h"
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+//Functions
+int best_in_class(const int stat[], int mask);
+
+/*
+* The training set holds the uppercase letters A-Z in 0-25, the numbers
+* 0-9 in 26-35 and the lowercase letters k-z in 36-51.
+*/
+int template_class(int index)
+{
+    if (index < 26)
+        return CLASS_LETTER;
+    else if (index < 36)
+        return CLASS_DIGIT;
+    return CLASS_LOWER;
+}
+
+void default_grammar(PlateGrammar &grammar)
+{
+    grammar.count = 0;
+    add_pattern(grammar, "LLL-DDDD?"); //Cars (ABC 123 and ABC 1234)
+    add_pattern(grammar, "DDD-LLL");   //Motorcycles (123 ABC)
+    add_pattern(grammar, "LL-DDDDD?"); //Motorcycles (AB 1234 and AB 12345)
+}
+
+bool add_pattern(PlateGrammar &grammar, const char *pattern)
+{
+    if (grammar.count == MAX_GRAMMARS)
+        return false;
+
+    int p = grammar.count;
+    int len = 0;
+    for (const char *c = pattern; *c != '\0'; c++)
+    {
+        if (*c == ' ' || *c == '-')
+            continue;
+
+        //Optional Character
+        if (*c == '?')
+        {
+            if (len == 0)
+                return false;
+            grammar.optional[p][len-1] = true;
+            continue;
+        }
+
+        if (len == MAX_PATTERN)
+            return false;
+        if (*c == 'L')
+            grammar.classes[p][len] = CLASS_LETTER;
+        else if (*c == 'D')
+            grammar.classes[p][len] = CLASS_DIGIT;
+        else if (*c == 'A')
+            grammar.classes[p][len] = CLASS_LETTER | CLASS_DIGIT;
+        else
+            return false;
+        grammar.optional[p][len] = false;
+        len++;
+    }
+    if (len == 0)
+        return false;
+
+    grammar.length[p] = len;
+    grammar.count++;
+    return true;
+}
+
+bool load_grammar(const char *filename, PlateGrammar &grammar)
+{
+    ifstream myfile (filename);
+    if (!myfile.is_open())
+        return false;
+
+    grammar.count = 0;
+    string line;
+    while (getline(myfile, line))
+    {
+        //Removes Comments and Blank Lines
+        size_t hash = line.find('#');
+        if (hash != string::npos)
+            line.erase(hash);
+        if (line.find_first_not_of(" \t\r") == string::npos)
+            continue;
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        line.erase(0, line.find_first_not_of(" \t"));
+
+        if (!add_pattern(grammar, line.c_str()))
+            return false;
+    }
+    return grammar.count > 0;
+}
+
+/*
+* A format is a chain of states, one per character, so a glyph can only
+* sit on a character that is reachable from the start with the glyphs
+* before it and that can still reach the end with the glyphs after it.
+* The classes of these characters over all formats are the only templates
+* worth matching for that glyph. For a plate that fits a single format
+* this leaves only the letters or only the numbers.
+*/
+bool allowed_classes(const PlateGrammar &grammar, int num_letters,
+    int classes[])
+{
+    bool fwd[MAX_LETTERS+1][MAX_PATTERN+1];
+    bool bwd[MAX_LETTERS+1][MAX_PATTERN+1];
+    bool fits = false;
+
+    for (int g = 0; g < num_letters; g++)
+    {
+        classes[g] = 0;
+    }
+    if (num_letters > MAX_LETTERS)
+        return false;
+
+    for (int p = 0; p < grammar.count; p++)
+    {
+        int len = grammar.length[p];
+        if (num_letters > len)
+            continue;
+
+        //Forward Pass
+        for (int g = 0; g <= num_letters; g++)
+        {
+            for (int j = 0; j <= len; j++)
+            {
+                fwd[g][j] = (g == 0 && j == 0);
+                if (g > 0 && j > 0 && fwd[g-1][j-1])
+                    fwd[g][j] = true;
+                if (j > 0 && grammar.optional[p][j-1] && fwd[g][j-1])
+                    fwd[g][j] = true;
+            }
+        }
+
+        //Backward Pass
+        for (int g = num_letters; g >= 0; g--)
+        {
+            for (int j = len; j >= 0; j--)
+            {
+                bwd[g][j] = (g == num_letters && j == len);
+                if (g < num_letters && j < len && bwd[g+1][j+1])
+                    bwd[g][j] = true;
+                if (j < len && grammar.optional[p][j] && bwd[g][j+1])
+                    bwd[g][j] = true;
+            }
+        }
+        if (!fwd[num_letters][len])
+            continue;
+        fits = true;
+
+        //Characters Each Glyph Can Take
+        for (int g = 0; g < num_letters; g++)
+        {
+            for (int j = 0; j < len; j++)
+            {
+                if (fwd[g][j] && bwd[g+1][j+1])
+                    classes[g] |= grammar.classes[p][j];
+            }
+        }
+    }
+    return fits;
+}
+
+/*
+* Viterbi Decoding
+* Each format is walked as a chain of states where score[g][j] is the best
+* sum of template scores after g glyphs have been placed on the first j
+* characters. Placing glyph g on character j adds the score of its best
+* template of that class, and an optional character can be passed without
+* taking a glyph. The best full path over all formats is then traced back
+* to get the template of every glyph.
+*/
+bool decode_plate(const PlateGrammar &grammar,
+    const int stat[][NUM_TEMPLATES], int num_letters, int decoded[])
+{
+    int score[MAX_LETTERS+1][MAX_PATTERN+1];
+    int prev[MAX_LETTERS+1][MAX_PATTERN+1];   //State of the previous step
+    int choice[MAX_LETTERS+1][MAX_PATTERN+1]; //Template, -1 if skipped
+    int best[MAX_LETTERS][CLASS_ANY+1];
+    int best_score = -1;
+
+    if (num_letters == 0 || num_letters > MAX_LETTERS)
+        return false;
+
+    //Best Template of Each Class per Glyph
+    for (int g = 0; g < num_letters; g++)
+    {
+        for (int mask = 1; mask <= CLASS_ANY; mask++)
+        {
+            best[g][mask] = best_in_class(stat[g], mask);
+        }
+    }
+
+    for (int p = 0; p < grammar.count; p++)
+    {
+        int len = grammar.length[p];
+        if (num_letters > len)
+            continue;
+
+        for (int g = 0; g <= num_letters; g++)
+        {
+            for (int j = 0; j <= len; j++)
+            {
+                score[g][j] = -1;
+            }
+        }
+        score[0][0] = 0;
+
+        for (int g = 0; g <= num_letters; g++)
+        {
+            //Skipping of Optional Characters
+            for (int j = 0; j < len; j++)
+            {
+                if (grammar.optional[p][j] && score[g][j] > score[g][j+1])
+                {
+                    score[g][j+1] = score[g][j];
+                    prev[g][j+1] = j;
+                    choice[g][j+1] = -1;
+                }
+            }
+            if (g == num_letters)
+                break;
+
+            //Placing of the Next Glyph
+            for (int j = 0; j < len; j++)
+            {
+                if (score[g][j] < 0)
+                    continue;
+                int t = best[g][grammar.classes[p][j]];
+                if (t < 0)
+                    continue;
+                int s = score[g][j] + stat[g][t];
+                if (s > score[g+1][j+1])
+                {
+                    score[g+1][j+1] = s;
+                    prev[g+1][j+1] = j;
+                    choice[g+1][j+1] = t;
+                }
+            }
+        }
+
+        //Traces Back the Best Path of this Format
+        if (score[num_letters][len] > best_score)
+        {
+            best_score = score[num_letters][len];
+            int g = num_letters;
+            int j = len;
+            while (g > 0)
+            {
+                int t = choice[g][j];
+                j = prev[g][j];
+                if (t >= 0)
+                {
+                    g--;
+                    decoded[g] = t;
+                }
+            }
+        }
+    }
+    return best_score >= 0;
+}
+
+//Supplementary Code
+int best_in_class(const int stat[], int mask)
+{
+    int best = -1;
+    for (int i = 0; i < NUM_TEMPLATES; i++)
+    {
+        if ((template_class(i) & mask) && stat[i] >= 0 &&
+            (best == -1 || stat[i] >= stat[best]))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
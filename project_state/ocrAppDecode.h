@@ -0,0 +1,63 @@
+/***************************************************************
+ * Name:      ocrAppDecode.h
+ * Purpose:   Defines Plate Grammars and Format-Constrained Decoding
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPDECODE_H
+#define OCRAPPDECODE_H
+
+#include "ocrAppMatch.h"
+
+//Definitions
+#define MAX_GRAMMARS 8   //Number of plate formats that can be loaded
+#define MAX_PATTERN 16   //Number of characters in a plate format
+#define MAX_LETTERS 52   //Number of glyphs in a word (see theinputs)
+
+//Character Classes of the Templates
+#define CLASS_LETTER 1   //Uppercase letters A-Z
+#define CLASS_DIGIT  2   //Numbers 0-9
+#define CLASS_LOWER  4   //Lowercase letters k-z
+#define CLASS_ANY    7
+
+/*
+* A plate format is written one character per glyph:
+*   L   an uppercase letter
+*   D   a number
+*   A   a letter or a number
+*   ?   makes the previous character optional
+* Spaces and dashes are only for readability, so "LLL-DDDD?" accepts
+* both ABC 123 and ABC 1234.
+*/
+struct PlateGrammar
+{
+    int count;                                //Number of formats
+    int length[MAX_GRAMMARS];                 //Characters per format
+    int classes[MAX_GRAMMARS][MAX_PATTERN];   //Class of each character
+    bool optional[MAX_GRAMMARS][MAX_PATTERN]; //Whether it can be skipped
+};
+
+//Grammar Functions
+//Class of a template index (see MyFrame::converter)
+int template_class(int index);
+//Loads the Philippine plate formats
+void default_grammar(PlateGrammar &grammar);
+//Adds a format, returns false if it cannot be parsed
+bool add_pattern(PlateGrammar &grammar, const char *pattern);
+//Loads one format per line, '#' starts a comment
+bool load_grammar(const char *filename, PlateGrammar &grammar);
+
+//Decoding Functions
+//Classes each glyph may take in a word of num_letters glyphs,
+//returns false if no format has that many characters
+bool allowed_classes(const PlateGrammar &grammar, int num_letters,
+    int classes[]);
+//Finds the templates of the best word that fits one of the formats.
+//stat holds the scores of every glyph, -1 for unmatched templates.
+//Returns false if no format fits
+bool decode_plate(const PlateGrammar &grammar,
+    const int stat[][NUM_TEMPLATES], int num_letters, int decoded[]);
+
+#endif
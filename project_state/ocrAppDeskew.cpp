@@ -0,0 +1,234 @@
+/***************************************************************
+ * Name:      ocrAppDeskew.cpp
+ * Purpose:   Code for the Estimation of the Rotation and the Slant
+ *            of a Plate, and its Straightening
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppDeskew.h"
+#include "PerspectiveTransform.h"
+#include <math.h>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+//A Black Pixel of the Sampled Copy, in Coordinates of the Image
+struct SkewPoint
+{
+    double x, y;
+};
+
+//Functions
+double profile_energy(const vector<SkewPoint> &points, double dx,
+    double dy, double step, vector<int> &bins);
+double best_angle(int maxDegrees, const function<double(double)> &energy,
+    double &gain);
+
+//Definitions
+#define SKEW_STEP 0.25  //Finest angle searched, in degrees
+#define SKEW_MIN 0.5    //Smaller rotations and slants are left alone
+#define SKEW_GAIN 1.05  //Profile energy an angle needs over straight
+#define SKEW_POINTS 50  //Fewer black samples are not worth a search
+#define DEGREES (M_PI / 180)
+
+/*
+* The text of a plate lies on a line, so when the black pixels are
+* projected across that line (one count per row) they pile up in few
+* rows, with empty rows above and below; on a rotated plate the same
+* pixels are spread over many rows. The rotation is the angle whose row
+* profile has the largest sum of squared counts. Letters printed or seen
+* slanted are then straightened the same way, with the column profile:
+* at the right slant the strokes and the gaps between letters line up
+* with whole columns, which is what segmentation_word needs.
+*
+* Both are searched on a copy sampled down to SKEW_SAMPLE pixels on its
+* longest side, in whole degrees and then in SKEW_STEP around the best.
+* The text found is described by the four corners of the parallelogram
+* it occupies in the image, which are what PerspectiveTransform needs
+* to map a straight rectangle back onto it.
+*/
+bool estimate_skew(const OcrImage &binary, int maxDegrees,
+    SkewEstimate &skew)
+{
+    int windowx = binary.GetWidth();
+    int windowy = binary.GetHeight();
+    if (maxDegrees <= 0 || windowx <= 0 || windowy <= 0)
+        return false;
+    if (maxDegrees > MAX_SKEW)
+        maxDegrees = MAX_SKEW;
+
+    //Black Pixels of the Sampled Copy
+    int longest = (windowx > windowy) ? windowx : windowy;
+    int step = (longest + SKEW_SAMPLE - 1) / SKEW_SAMPLE;
+    vector<SkewPoint> points;
+    const unsigned char *data = binary.GetData();
+    for (int y = 0; y < windowy; y += step)
+    {
+        for (int x = 0; x < windowx; x += step)
+        {
+            if (data[((size_t)y * windowx + x) * 3] == 0)
+            {
+                SkewPoint point = { (double)x, (double)y };
+                points.push_back(point);
+            }
+        }
+    }
+    if (points.size() < SKEW_POINTS)
+        return false;
+
+    //Bins for any Projection of the Image, Slant Included
+    vector<int> bins(4 * (windowx + windowy) / step + 8);
+
+    //Rotation, from the Row Profile
+    double gain;
+    double angle = best_angle(maxDegrees, [&](double degrees)
+    {
+        return profile_energy(points, -sin(degrees * DEGREES),
+            cos(degrees * DEGREES), step, bins);
+    }, gain);
+    if (gain < SKEW_GAIN)
+        angle = 0;
+    double c = cos(angle * DEGREES), s = sin(angle * DEGREES);
+
+    //Slant, from the Column Profile of the Rotated Text
+    double shear = best_angle(maxDegrees, [&](double degrees)
+    {
+        double k = tan(degrees * DEGREES);
+        return profile_energy(points, c + k * s, s - k * c, step, bins);
+    }, gain);
+    if (gain < SKEW_GAIN)
+        shear = 0;
+    if (fabs(angle) < SKEW_MIN && fabs(shear) < SKEW_MIN)
+        return false;
+    double k = tan(shear * DEGREES);
+
+    //Extent of the Text, Straightened (u Across, v Down)
+    double umin = 1e30, umax = -1e30, vmin = 1e30, vmax = -1e30;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        double v = -points[i].x * s + points[i].y * c;
+        double u = points[i].x * c + points[i].y * s - k * v;
+        umin = (u < umin) ? u : umin;
+        umax = (u > umax) ? u : umax;
+        vmin = (v < vmin) ? v : vmin;
+        vmax = (v > vmax) ? v : vmax;
+    }
+    //A Sample Stands for the step x step Pixels after It
+    umax += step;
+    vmax += step;
+
+    //Corners, Back in the Image
+    double straight[4][2] =
+    {
+        { umin, vmin }, { umax, vmin }, { umax, vmax }, { umin, vmax }
+    };
+    for (int i = 0; i < 4; i++)
+    {
+        double v = straight[i][1];
+        double u = straight[i][0] + k * v;
+        skew.corners[i][0] = u * c - v * s;
+        skew.corners[i][1] = u * s + v * c;
+    }
+    skew.angle = angle;
+    skew.shear = shear;
+    skew.width = (int)ceil(umax - umin);
+    skew.height = (int)ceil(vmax - vmin);
+    return true;
+}
+
+/*
+* Every pixel of the straightened plate is taken from the point of the
+* image it comes from (nearest neighbour), so the result has no holes
+* and stays binary. What falls outside the image is background.
+*/
+bool deskew(OcrImage &binary, int maxDegrees)
+{
+    SkewEstimate skew;
+    if (!estimate_skew(binary, maxDegrees, skew))
+        return false;
+
+    //The Unit Square Mapped onto the Corners
+    PerspectiveTransform identity(1, 0, 0, 0, 1, 0, 0, 0, 1);
+    PerspectiveTransform warp = identity.squareToQuadrilateral(
+        skew.corners[0][0], skew.corners[0][1],
+        skew.corners[1][0], skew.corners[1][1],
+        skew.corners[2][0], skew.corners[2][1],
+        skew.corners[3][0], skew.corners[3][1]);
+
+    int windowx = binary.GetWidth();
+    int windowy = binary.GetHeight();
+    const unsigned char *source = binary.GetData();
+    OcrImage result(skew.width, skew.height);
+    unsigned char *target = result.GetData();
+    for (int j = 0; j < skew.height; j++)
+    {
+        for (int i = 0; i < skew.width; i++)
+        {
+            double x, y;
+            warp.transformPoint((i + 0.5) / skew.width,
+                (j + 0.5) / skew.height, x, y);
+            int lum = 255;
+            if (x >= 0 && y >= 0 && x < windowx && y < windowy)
+                lum = source[((size_t)(int)y * windowx + (int)x) * 3];
+            target[0] = target[1] = target[2] = lum;
+            target += 3;
+        }
+    }
+    binary = result;
+    return true;
+}
+
+//Supplementary Code
+//Sum of the squared counts of the points projected on (dx, dy), in
+//bins of the sampling step. Larger when the points gather in fewer bins
+double profile_energy(const vector<SkewPoint> &points, double dx,
+    double dy, double step, vector<int> &bins)
+{
+    int offset = bins.size() / 2;
+    fill(bins.begin(), bins.end(), 0);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        double p = (points[i].x * dx + points[i].y * dy) / step;
+        bins[offset + (int)floor(p)]++;
+    }
+    double energy = 0;
+    for (size_t b = 0; b < bins.size(); b++)
+        energy += (double)bins[b] * bins[b];
+    return energy;
+}
+
+//The angle within maxDegrees either way with the most energy, and how
+//much more energy it has than no angle at all
+double best_angle(int maxDegrees, const function<double(double)> &energy,
+    double &gain)
+{
+    double straight = energy(0);
+    double best = 0, most = straight;
+    for (int d = -maxDegrees; d <= maxDegrees; d++)
+    {
+        double e = energy(d);
+        if (e > most)
+        {
+            most = e;
+            best = d;
+        }
+    }
+    double coarse = best;
+    for (double d = coarse - 1 + SKEW_STEP; d < coarse + 1; d += SKEW_STEP)
+    {
+        if (fabs(d) > maxDegrees)
+            continue;
+        double e = energy(d);
+        if (e > most)
+        {
+            most = e;
+            best = d;
+        }
+    }
+    gain = (straight > 0) ? most / straight : 0;
+    return best;
+}
@@ -0,0 +1,40 @@
+/***************************************************************
+ * Name:      ocrAppDeskew.h
+ * Purpose:   Defines the Estimation of the Rotation and the Slant
+ *            of a Plate, and its Straightening
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPDESKEW_H
+#define OCRAPPDESKEW_H
+
+#include "ocrImage.h"
+
+//Definitions
+#define MAX_SKEW 30        //Largest rotation or slant searched, in degrees
+#define DESKEW_DEGREES 15  //Searched by default
+#define SKEW_SAMPLE 200    //Longest side of the copy the search runs on
+
+//Rotation and Slant of the Text of a Binary Plate
+struct SkewEstimate
+{
+    double angle;          //Rotation that levels the lines, in degrees
+    double shear;          //Slant that then straightens the letters
+    double corners[4][2];  //Corners of the text in the image: top-left,
+                           //top-right, bottom-right and bottom-left
+    int width;             //Size of the text once straightened
+    int height;
+};
+
+//Skew Functions
+//Searches both up to maxDegrees either way. Returns false when the text
+//is straight already (or there is none), and the estimate is not filled
+bool estimate_skew(const OcrImage &binary, int maxDegrees,
+    SkewEstimate &skew);
+//Replaces the binary image by its text, straightened and cropped, when
+//estimate_skew finds it skewed. Returns whether it was
+bool deskew(OcrImage &binary, int maxDegrees);
+
+#endif
@@ -0,0 +1,1140 @@
+/***************************************************************
+ * Name:      ocrAppEngine.cpp
+ * Purpose:   Code for the Recognition Engine shared by the GUI
+ *            and the Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppEngine.h"
+#include "ocrAppPrepro.h"
+#include "ocrImageIO.h"
+#include <sstream>
+#include <chrono>
+#include <string.h>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+using namespace std;
+
+//Functions
+void best_samples(const OcrBank &bank, const int scores[], int numPixels,
+    int lpixels, int stat[]);
+void lap(double timings[], int stage, chrono::steady_clock::time_point &start);
+
+//Definitions
+#define MATCH_SLICE 8 //Letters matched together by one thread
+
+/*
+* The slots of recognize_stream: the letters of the plates are packed
+* into them as soon as they are cut, at every level the matcher reads,
+* and the letters themselves go.
+*/
+struct GlyphSlots
+{
+    int used;                              //Letters in the Slots
+    vector<uint64_t> bits[PYRAMID_LEVELS]; //GLYPH_SLOTS Glyphs per Level
+};
+
+const char *const stage_names[NUM_STAGES] =
+{
+    "gray", "binary", "plate", "letters", "match"
+};
+
+const char *const gate_names[NUM_GATES] =
+{
+    "passed", "blurred", "flat", "letters"
+};
+
+GateOptions::GateOptions()
+    : sharpness(GATE_SHARPNESS), spread(GATE_SPREAD),
+    min_letters(GATE_MIN_LETTERS), max_letters(MAX_LETTERS - 1)
+{
+}
+
+OcrEngine::OcrEngine()
+{
+    size = GLYPH_LARGE;
+    numPixels = size * size;
+    words = WORDS_FOR(numPixels);
+    levels = 1;
+    margin = 0;
+    skew = DESKEW_DEGREES;
+    cleanup = true;
+    compact = false;
+    gate = false;
+    matcher = MATCH_PIXELS;
+    pool = NULL;
+    revisions = 0;
+    plateRevisions = 0;
+
+    //Until Trained, every Template has a Black Sample
+    OcrImage blank[NUM_TEMPLATES];
+    train(blank);
+    revisions = 0;
+    default_grammar(grammar);
+}
+
+//Loading Functions
+bool OcrEngine::train(const string &dir)
+{
+    OcrImage images[NUM_TEMPLATES];
+    bool ok = true;
+    //Loads Images
+    for (int i=0; i<NUM_TEMPLATES; i++)
+    {
+        if (!load_image(template_file(dir, i), images[i]))
+            ok = false;
+    }
+    train(images);
+    return ok;
+}
+
+void OcrEngine::train(const OcrImage images[])
+{
+    //One Sample per Template
+    update([&](OcrBank &bank)
+    {
+        bank.packed.clear();
+        bank.samples.resize(NUM_TEMPLATES);
+        bank.templates.resize(NUM_TEMPLATES);
+        for (int i=0; i<NUM_TEMPLATES; i++)
+        {
+            //Images that could not be loaded are left black
+            bank.samples[i] = images[i];
+            if (!bank.samples[i].IsOk())
+                bank.samples[i].Create(size, size);
+            prepare_sample(bank.samples[i]);
+            bank.templates[i] = i;
+        }
+        build_bank(bank);
+        return true;
+    });
+}
+
+/*
+* The cropped letters of the samples are kept, so the bank can be rebuilt
+* at another glyph size without loading the images again. Every pyramid
+* level is built, whether the matching uses it or not.
+*/
+void OcrEngine::build_bank(OcrBank &bank) const
+{
+    int count = bank.templates.size();
+    bank.size = size;
+    for (int l = 0; l < PYRAMID_LEVELS; l++)
+    {
+        int lsize = PYRAMID_SIZE(size, l);
+        bank.bits[l].assign(count * WORDS_FOR(lsize * lsize), 0);
+    }
+    bank.models.assign(count, ChamferModel());
+    for (int i = 0; i < count; i++)
+        build_sample(bank, i);
+}
+
+//Packs a sample whose slots are in place, and builds its model
+void OcrEngine::build_sample(OcrBank &bank, int sample) const
+{
+    OcrImage temp = sample_image(bank, sample);
+    rescale_glyph(temp, size);
+    for (int l = 0; l < PYRAMID_LEVELS; l++)
+    {
+        int lsize = PYRAMID_SIZE(size, l);
+        int lwords = WORDS_FOR(lsize * lsize);
+        pack_letter(temp, l, &bank.bits[l][sample * lwords]);
+    }
+    if (keeps_models())
+        chamfer_model(&bank.bits[0][sample * words], size, size,
+            bank.models[sample]);
+    else
+        bank.models[sample] = ChamferModel();
+}
+
+//Appends a prepared sample, then drops the second oldest of its template
+//when that has more than MAX_SAMPLES
+void OcrEngine::insert_sample(OcrBank &bank, int index,
+    const OcrImage &sample) const
+{
+    //Room in Every Level
+    int last = bank.templates.size();
+    if (bank.samples.empty())
+    {
+        bank.packed.push_back(OcrBitmap());
+        pack_bitmap(sample, bank.packed.back());
+    }
+    else
+        bank.samples.push_back(sample);
+    bank.templates.push_back(index);
+    bank.models.push_back(ChamferModel());
+    for (int l = 0; l < PYRAMID_LEVELS; l++)
+    {
+        int lsize = PYRAMID_SIZE(size, l);
+        bank.bits[l].resize((last + 1) * WORDS_FOR(lsize * lsize), 0);
+    }
+    build_sample(bank, last);
+
+    int count = 0, second = -1;
+    for (int i = 0; i <= last; i++)
+    {
+        if (bank.templates[i] == index && ++count == 2)
+            second = i;
+    }
+    if (count > MAX_SAMPLES)
+        erase_sample(bank, second);
+}
+
+void OcrEngine::erase_sample(OcrBank &bank, int sample) const
+{
+    if (bank.samples.empty())
+        bank.packed.erase(bank.packed.begin() + sample);
+    else
+        bank.samples.erase(bank.samples.begin() + sample);
+    bank.templates.erase(bank.templates.begin() + sample);
+    bank.models.erase(bank.models.begin() + sample);
+    for (int l = 0; l < PYRAMID_LEVELS; l++)
+    {
+        int lsize = PYRAMID_SIZE(size, l);
+        int lwords = WORDS_FOR(lsize * lsize);
+        bank.bits[l].erase(bank.bits[l].begin() + sample * lwords,
+            bank.bits[l].begin() + (sample + 1) * lwords);
+    }
+}
+
+/*
+* Brings what the bank keeps in line with the settings: the samples as
+* images or with 1 bit per pixel, and the chamfer models.
+* Whatever is already there and still wanted is kept as it is.
+*/
+void OcrEngine::complete(OcrBank &bank) const
+{
+    int count = bank.templates.size();
+
+    //Samples in the Form of the Mode
+    if (compact && !bank.samples.empty())
+    {
+        bank.packed.resize(count);
+        for (int i = 0; i < count; i++)
+            pack_bitmap(bank.samples[i], bank.packed[i]);
+        vector<OcrImage>().swap(bank.samples);
+    }
+    else if (!compact && !bank.packed.empty())
+    {
+        bank.samples.resize(count);
+        for (int i = 0; i < count; i++)
+            unpack_bitmap(bank.packed[i], bank.samples[i]);
+        vector<OcrBitmap>().swap(bank.packed);
+    }
+
+    //Models of the Matcher
+    for (int i = 0; i < count; i++)
+    {
+        if (!keeps_models())
+            bank.models[i] = ChamferModel();
+        else if (bank.models[i].dist.empty())
+            chamfer_model(&bank.bits[0][i * words], size, size,
+                bank.models[i]);
+    }
+}
+
+//Whether complete() would leave the bank as it is
+bool OcrEngine::completed(const OcrBank &bank) const
+{
+    if (compact != bank.samples.empty())
+        return false;
+    for (size_t i = 0; i < bank.models.size(); i++)
+    {
+        if (keeps_models() == bank.models[i].dist.empty())
+            return false;
+    }
+    return true;
+}
+
+//Chamfer models are only left out to save memory, when compact
+bool OcrEngine::keeps_models() const
+{
+    return !compact || matcher == MATCH_CHAMFER;
+}
+
+//A sample as an image, whichever way the bank keeps it
+OcrImage OcrEngine::sample_image(const OcrBank &bank, int sample)
+{
+    if (!bank.samples.empty())
+        return bank.samples[sample].Copy();
+    OcrImage image;
+    unpack_bitmap(bank.packed[sample], image);
+    return image;
+}
+
+//The filters every sample goes through, as the letters of the training set
+void OcrEngine::prepare_sample(OcrImage &image) const
+{
+    grayscale(image);
+    threshold(image, 1);
+    segmentation(image);
+}
+
+string OcrEngine::template_file(const string &dir, int index)
+{
+    //Converts int to string
+    stringstream cnter;
+    cnter << index + 11;
+    return dir + "/img0" + cnter.str() + "-00986.png";
+}
+
+/*
+* Read-Copy-Update: a change is made to a copy of the current bank, which
+* then replaces it with a single atomic store. Recognitions load the
+* pointer once and keep their copy alive for as long as they use it, so
+* the old bank goes away with the last recognition that started on it.
+* Only the writers take the lock, to not lose each other's changes.
+*/
+bool OcrEngine::update(const function<bool(OcrBank &bank)> &change)
+{
+    lock_guard<mutex> guard(updates);
+    shared_ptr<const OcrBank> current = atomic_load(&bank);
+    shared_ptr<OcrBank> next(current != NULL ?
+        new OcrBank(*current) : new OcrBank());
+    if (!change(*next))
+        return false;
+    complete(*next);
+    atomic_store(&bank, shared_ptr<const OcrBank>(next));
+    revisions++;
+    return true;
+}
+
+//Publishes a completed copy of the bank after a change of the settings
+void OcrEngine::refresh()
+{
+    lock_guard<mutex> guard(updates);
+    shared_ptr<const OcrBank> current = atomic_load(&bank);
+    if (completed(*current))
+        return;
+    shared_ptr<OcrBank> next(new OcrBank(*current));
+    complete(*next);
+    atomic_store(&bank, shared_ptr<const OcrBank>(next));
+}
+
+//Online Training Functions
+bool OcrEngine::add_sample(int index, const OcrImage &image)
+{
+    if (index < 0 || index >= NUM_TEMPLATES || !image.IsOk())
+        return false;
+    OcrImage sample = image.Copy();
+    prepare_sample(sample);
+    return update([&](OcrBank &bank)
+    {
+        insert_sample(bank, index, sample);
+        return true;
+    });
+}
+
+bool OcrEngine::replace_samples(int index, const OcrImage &image)
+{
+    if (index < 0 || index >= NUM_TEMPLATES || !image.IsOk())
+        return false;
+    OcrImage sample = image.Copy();
+    prepare_sample(sample);
+    return update([&](OcrBank &bank)
+    {
+        //The First Sample is Rebuilt in Place, the Others Go
+        int first = -1;
+        for (int i = bank.templates.size() - 1; i >= 0; i--)
+        {
+            if (bank.templates[i] != index)
+                continue;
+            if (first >= 0)
+                erase_sample(bank, first);
+            first = i;
+        }
+        if (first < 0)
+        {
+            insert_sample(bank, index, sample);
+            return true;
+        }
+        if (bank.samples.empty())
+            pack_bitmap(sample, bank.packed[first]);
+        else
+            bank.samples[first] = sample;
+        build_sample(bank, first);
+        return true;
+    });
+}
+
+bool OcrEngine::remove_samples(int index)
+{
+    if (index < 0 || index >= NUM_TEMPLATES)
+        return false;
+    return update([&](OcrBank &bank)
+    {
+        int others = 0;
+        for (size_t i = 0; i < bank.templates.size(); i++)
+            others += bank.templates[i] != index;
+        if (others == 0)
+            return false;
+        for (int i = bank.templates.size() - 1; i >= 0; i--)
+        {
+            if (bank.templates[i] == index)
+                erase_sample(bank, i);
+        }
+        return true;
+    });
+}
+
+int OcrEngine::sample_count(int index) const
+{
+    shared_ptr<const OcrBank> current = templates();
+    int count = 0;
+    for (size_t i = 0; i < current->templates.size(); i++)
+        count += current->templates[i] == index;
+    return count;
+}
+
+/*
+* Only the letters that were read wrong are learned: those read right
+* already match a sample well enough, and adding them would only push
+* older samples out. All of them go into the bank in one update.
+*/
+int OcrEngine::learn(const OcrImage letters[], const PlateResult &result,
+    const string &confirmed)
+{
+    if ((int)confirmed.size() != result.num_letters ||
+        (int)result.word.size() != result.num_letters)
+        return -1;
+    vector<int> indices;
+    vector<OcrImage> samples;
+    for (int i = 0; i < result.num_letters; i++)
+    {
+        if (result.word[i] != confirmed[i] &&
+            template_index(confirmed[i]) >= 0 && letters[i].IsOk())
+        {
+            indices.push_back(template_index(confirmed[i]));
+            samples.push_back(letters[i].Copy());
+            prepare_sample(samples.back());
+        }
+    }
+    if (indices.empty())
+        return 0;
+    update([&](OcrBank &bank)
+    {
+        for (size_t k = 0; k < indices.size(); k++)
+            insert_sample(bank, indices[k], samples[k]);
+        return true;
+    });
+    return indices.size();
+}
+
+shared_ptr<const OcrBank> OcrEngine::templates() const
+{
+    return atomic_load(&bank);
+}
+
+int OcrEngine::template_index(char ch)
+{
+    //The Inverse of converter
+    if (ch >= 'A' && ch <= 'Z')
+        return ch - 65;
+    if (ch >= '0' && ch <= '9')
+        return ch - 22;
+    if (ch >= 'k' && ch <= 'z')
+        return ch - 71;
+    return -1;
+}
+
+bool OcrEngine::load_formats(const string &filename)
+{
+    revisions++;
+    if (load_grammar(filename.c_str(), grammar))
+        return true;
+    default_grammar(grammar);
+    return false;
+}
+
+void OcrEngine::set_matcher(int matcher)
+{
+    this->matcher = matcher;
+    revisions++;
+    refresh();
+}
+
+bool OcrEngine::set_glyph_size(int size)
+{
+    if (size < 8)
+        return false;
+    this->size = size;
+    numPixels = size * size;
+    words = WORDS_FOR(numPixels);
+    update([&](OcrBank &bank)
+    {
+        build_bank(bank);
+        return true;
+    });
+    return true;
+}
+
+int OcrEngine::glyph_size() const
+{
+    return size;
+}
+
+bool OcrEngine::set_pyramid(int levels, double margin)
+{
+    if (levels < 1 || levels > PYRAMID_LEVELS || margin < 0)
+        return false;
+    this->levels = levels;
+    this->margin = margin;
+    revisions++;
+    return true;
+}
+
+bool OcrEngine::set_deskew(int degrees)
+{
+    if (degrees < 0 || degrees > MAX_SKEW)
+        return false;
+    skew = degrees;
+    revisions++;
+    plateRevisions++;
+    return true;
+}
+
+int OcrEngine::deskew_limit() const
+{
+    return skew;
+}
+
+void OcrEngine::set_cleanup(bool enabled)
+{
+    cleanup = enabled;
+    revisions++;
+    plateRevisions++;
+}
+
+bool OcrEngine::cleanup_enabled() const
+{
+    return cleanup;
+}
+
+long OcrEngine::plate_revision() const
+{
+    return plateRevisions;
+}
+
+//Readings do not change, so neither does the revision
+void OcrEngine::set_compact(bool enabled)
+{
+    compact = enabled;
+    refresh();
+}
+
+bool OcrEngine::compact_enabled() const
+{
+    return compact;
+}
+
+//Frames that are read are read the same, so the revisions stay
+void OcrEngine::set_gate(bool enabled, const GateOptions &options)
+{
+    gate = enabled;
+    gateOptions = options;
+}
+
+bool OcrEngine::gate_enabled() const
+{
+    return gate;
+}
+
+size_t OcrEngine::bank_bytes() const
+{
+    shared_ptr<const OcrBank> current = templates();
+    size_t bytes = 0;
+    for (size_t i = 0; i < current->samples.size(); i++)
+    {
+        bytes += (size_t)current->samples[i].GetWidth() *
+            current->samples[i].GetHeight() * 3;
+    }
+    for (size_t i = 0; i < current->packed.size(); i++)
+        bytes += current->packed[i].bits.size() * sizeof(uint64_t);
+    for (int l = 0; l < PYRAMID_LEVELS; l++)
+        bytes += current->bits[l].size() * sizeof(uint64_t);
+    for (size_t i = 0; i < current->models.size(); i++)
+    {
+        bytes += current->models[i].dist.size() +
+            current->models[i].edges.size() * sizeof(int);
+    }
+    return bytes;
+}
+
+void OcrEngine::set_pool(OcrPool *pool)
+{
+    this->pool = pool;
+}
+
+long OcrEngine::revision() const
+{
+    return revisions;
+}
+
+/*
+* Runs body over [0, count) on the pool, grain items at a time, or at once
+* on the calling thread without a pool.
+*/
+void OcrEngine::parallel(int count, int grain,
+    const function<void(int, int)> &body) const
+{
+    if (pool != NULL)
+        pool->parallel_for(0, count, grain, body);
+    else if (count > 0)
+        body(0, count);
+}
+
+//Recognition Functions
+int OcrEngine::segment(OcrImage &image, OcrImage letters[],
+    double timings[], int *rejected) const
+{
+    //Apply Filters and Manipulations on Image
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int verdict = GATE_PASSED;
+    if (gate)
+    {
+        //Judged on a Sample of the Frame, before any Pass over it
+        FrameQuality quality;
+        frame_quality(image, quality);
+        verdict = judge_frame(quality);
+    }
+
+    int num_letters = 0;
+    if (verdict == GATE_PASSED)
+    {
+        to_gray(image);
+        lap(timings, STAGE_GRAY, start);
+        to_binary(image);
+        lap(timings, STAGE_BINARY, start);
+        //The Plate and its Letters are Windows of the Frame
+        OcrView plate = find_plate(image);
+        lap(timings, STAGE_PLATE, start);
+        OcrView windows[MAX_LETTERS];
+        num_letters = segment_letters(plate, windows);
+        if (gate)
+            verdict = judge_letters(windows, num_letters);
+        if (verdict == GATE_PASSED)
+            make_glyphs(windows, num_letters, letters);
+        else
+            num_letters = 0;
+        lap(timings, STAGE_LETTERS, start);
+    }
+    else if (timings != NULL)
+    {
+        //The Gate is Charged to the Stage it Replaces
+        lap(timings, STAGE_GRAY, start);
+        timings[STAGE_BINARY] = 0;
+        timings[STAGE_PLATE] = 0;
+        timings[STAGE_LETTERS] = 0;
+    }
+    if (rejected != NULL)
+        *rejected = verdict;
+    return num_letters;
+}
+
+void OcrEngine::to_gray(OcrImage &image) const
+{
+    color_plane(image, pool);
+}
+
+void OcrEngine::to_binary(OcrImage &image) const
+{
+    threshold(image, 0, pool);
+}
+
+void OcrEngine::crop_plate(OcrImage &image) const
+{
+    OcrView plate = find_plate(image);
+    if (plate.GetWidth() != image.GetWidth() ||
+        plate.GetHeight() != image.GetHeight())
+        image = plate.Copy();
+}
+
+OcrView OcrEngine::find_plate(OcrImage &image) const
+{
+    if (cleanup)
+        clean_binary(image);
+    deskew(image, skew);
+    return segment_window(image);
+}
+
+//Cuts the cropped plate into letters, each cropped and rescaled to a
+//glyph. The letters are windows of the plate until their glyph is made
+int OcrEngine::split_letters(const OcrView &plate, OcrImage letters[]) const
+{
+    OcrView windows[MAX_LETTERS];
+    int num_letters = segment_letters(plate, windows);
+    make_glyphs(windows, num_letters, letters);
+    return num_letters;
+}
+
+void OcrEngine::make_glyphs(const OcrView windows[], int num_letters,
+    OcrImage letters[]) const
+{
+    parallel(num_letters, 4, [&](int first, int last)
+    {
+        for (int a = first; a < last; a++)
+            normalize_glyph(windows[a], size, letters[a]);
+    });
+}
+
+//Verdict of the gate on a gray frame
+int OcrEngine::judge_frame(const FrameQuality &quality) const
+{
+    if (quality.spread < gateOptions.spread)
+        return GATE_FLAT;
+    if (quality.sharpness < gateOptions.sharpness)
+        return GATE_BLURRED;
+    return GATE_PASSED;
+}
+
+/*
+* The windows are the column runs segment_letters found, so judging them
+* costs nothing more. A run far wider than it is tall is the frame of
+* the plate or a bar of the car, not a letter, and a plate of noise
+* gives as many runs as there is room for.
+*/
+int OcrEngine::judge_letters(const OcrView windows[], int num_letters) const
+{
+    int plausible = 0;
+    for (int a = 0; a < num_letters; a++)
+    {
+        if (windows[a].GetWidth() <= GATE_ASPECT * windows[a].GetHeight())
+            plausible++;
+    }
+    if (plausible < gateOptions.min_letters ||
+        (gateOptions.max_letters > 0 && plausible > gateOptions.max_letters))
+        return GATE_LETTERS;
+    return GATE_PASSED;
+}
+
+void OcrEngine::identify(const OcrImage letters[], int num_letters,
+    PlateResult &result) const
+{
+    //Scores of All Letters against All Templates
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int level[MAX_LETTERS];
+    score_letters(letters, num_letters, &result.scores[0][0], level);
+
+    result.num_letters = num_letters;
+    interpret(result, level);
+    lap(result.timings, STAGE_MATCH, start);
+}
+
+void OcrEngine::recognize(const OcrImage &image, PlateResult &result) const
+{
+    OcrImage input = image.Copy();
+    OcrImage letters[MAX_LETTERS];
+    int num_letters = segment(input, letters, result.timings,
+        &result.rejected);
+    identify(letters, num_letters, result);
+}
+
+/*
+* The letters of every plate go into a single batch, so the templates
+* are streamed once for all of them instead of once per plate. With a
+* pool the plates are segmented in parallel, and the batch is matched in
+* slices of a few letters on every thread.
+*/
+void OcrEngine::recognize_batch(const OcrImage images[], int num_images,
+    PlateResult results[]) const
+{
+    if (compact)
+    {
+        recognize_stream(num_images, [&](int index, OcrImage &image)
+        {
+            image = images[index].Copy();
+            return true;
+        }, results);
+        return;
+    }
+
+    //Segmentation of Every Plate
+    vector< vector<OcrImage> > plates(num_images);
+    parallel(num_images, 1, [&](int first, int last)
+    {
+        for (int p = first; p < last; p++)
+        {
+            OcrImage input = images[p].Copy();
+            OcrImage plate[MAX_LETTERS];
+            int num_letters = segment(input, plate, results[p].timings,
+                &results[p].rejected);
+            results[p].num_letters = num_letters;
+            plates[p].assign(plate, plate + num_letters);
+        }
+    });
+    vector<OcrImage> letters;
+    for (int p = 0; p < num_images; p++)
+    {
+        letters.insert(letters.end(), plates[p].begin(), plates[p].end());
+    }
+
+    //Scores of All Letters of All Plates
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int total = letters.size();
+    vector<int> stat(total * NUM_TEMPLATES + 1);
+    vector<int> level(total + 1);
+    if (total > 0)
+        score_letters(&letters[0], total, &stat[0], &level[0]);
+    double match_us = 0;
+    lap(&match_us, 0, start);
+
+    //Interpretation per Plate
+    int first = 0;
+    for (int p = 0; p < num_images; p++)
+    {
+        int num_letters = results[p].num_letters;
+        for (int i = 0; i < num_letters; i++)
+        {
+            for (int t = 0; t < NUM_TEMPLATES; t++)
+            {
+                results[p].scores[i][t] = stat[(first + i) * NUM_TEMPLATES + t];
+            }
+        }
+        interpret(results[p], &level[first]);
+        first += num_letters;
+
+        //Every Plate is Charged for its Share of the Batch
+        results[p].timings[STAGE_MATCH] = (total > 0) ?
+            match_us * num_letters / total : 0;
+    }
+}
+
+/*
+* The plates are segmented one after the other, so a frame is gone before
+* the next one is decoded, and the letters of each are packed into the
+* slots and dropped. The slots are matched together whenever the letters
+* of the next plate would not fit, and at the end, so only the plates
+* whose letters are all in the slots are interpreted. The pool still
+* spreads the letters of a plate and their matching.
+*/
+void OcrEngine::recognize_stream(int num_images,
+    const function<bool(int index, OcrImage &image)> &load,
+    PlateResult results[]) const
+{
+    GlyphSlots slots;
+    slots.used = 0;
+    for (int l = 0; l < levels; l++)
+    {
+        int lsize = PYRAMID_SIZE(size, l);
+        slots.bits[l].resize(GLYPH_SLOTS * WORDS_FOR(lsize * lsize));
+    }
+
+    //Scores and Interpretation of the Plates in the Slots
+    int first = 0; //First Plate with Letters in the Slots
+    vector<int> stat(GLYPH_SLOTS * NUM_TEMPLATES);
+    vector<int> level(GLYPH_SLOTS);
+    auto match = [&](int end)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        score_glyphs(slots.used, [&](int letter, int l, uint64_t bits[])
+        {
+            int lsize = PYRAMID_SIZE(size, l);
+            int lwords = WORDS_FOR(lsize * lsize);
+            memcpy(bits, &slots.bits[l][letter * lwords],
+                lwords * sizeof(uint64_t));
+        }, &stat[0], &level[0]);
+        double match_us = 0;
+        lap(&match_us, 0, start);
+
+        int slot = 0;
+        for (int p = first; p < end; p++)
+        {
+            int num_letters = results[p].num_letters;
+            memcpy(results[p].scores, &stat[slot * NUM_TEMPLATES],
+                num_letters * NUM_TEMPLATES * sizeof(int));
+            interpret(results[p], &level[slot]);
+            slot += num_letters;
+
+            //Every Plate is Charged for its Share of the Slots
+            results[p].timings[STAGE_MATCH] = (slots.used > 0) ?
+                match_us * num_letters / slots.used : 0;
+        }
+        slots.used = 0;
+        first = end;
+    };
+
+
+    for (int p = 0; p <= num_images; p++)
+    {
+        //Letters of the Next Plate, then Matching of the Full Slots
+        int num_letters = 0;
+        OcrImage letters[MAX_LETTERS];
+        if (p < num_images)
+        {
+            OcrImage frame;
+            memset(results[p].timings, 0, sizeof(results[p].timings));
+            results[p].rejected = GATE_PASSED;
+            if (load(p, frame))
+                num_letters = segment(frame, letters, results[p].timings,
+                    &results[p].rejected);
+        }
+        if (p == num_images || slots.used + num_letters > GLYPH_SLOTS)
+            match(p);
+        if (p == num_images)
+            break;
+
+        //Letters of the Plate into the Slots
+        int used = slots.used;
+        parallel(num_letters, 4, [&](int begin, int end)
+        {
+            for (int a = begin; a < end; a++)
+            {
+                for (int l = 0; l < levels; l++)
+                {
+                    int lsize = PYRAMID_SIZE(size, l);
+                    int lwords = WORDS_FOR(lsize * lsize);
+                    pack_letter(letters[a], l,
+                        &slots.bits[l][(used + a) * lwords]);
+                }
+            }
+        });
+        results[p].num_letters = num_letters;
+        slots.used += num_letters;
+    }
+}
+
+/*
+* Packs a glyph at a level of the pyramid. The coarser levels are taken
+* from the full glyph, for the letters and the templates alike.
+*/
+void OcrEngine::pack_letter(const OcrImage &letter, int level,
+    uint64_t bits[]) const
+{
+    if (level == 0)
+        pack_bits(letter.GetData(), numPixels, bits);
+    else
+        pack_bits_scaled(letter.GetData(), size, PYRAMID_SIZE(size, level),
+            bits);
+}
+
+/*
+* All letters are matched at the coarsest level first. A letter whose two
+* best templates are at least margin apart is decided there, the others
+* go on to the next finer level. Letters are packed at a level only when
+* they reach it, so a letter decided at 25x25 is never packed at 100x100.
+* Scores are scaled to the pixels of the full glyph, so the decoder and
+* the confidence read them the same way whatever level they come from.
+*
+* Letters are matched against every sample of the bank, and each template
+* keeps the best score of its samples (-1 without samples, as a template
+* identifier leaves out). The chamfer matcher scores the full glyph
+* only.
+*/
+void OcrEngine::score_letters(const OcrImage letters[], int num_letters,
+    int stat[], int level[]) const
+{
+    score_glyphs(num_letters, [&](int letter, int l, uint64_t bits[])
+    {
+        pack_letter(letters[letter], l, bits);
+    }, stat, level);
+}
+
+//score_letters on the glyphs pack gives at every level
+void OcrEngine::score_glyphs(int num_letters,
+    const function<void(int letter, int level, uint64_t bits[])> &pack,
+    int stat[], int level[]) const
+{
+    vector<uint64_t> bits;
+    shared_ptr<const OcrBank> current = templates();
+    const OcrBank &bank = *current;
+    int numSamples = bank.templates.size();
+
+    if (matcher == MATCH_CHAMFER && !bank.models[0].dist.empty())
+    {
+        //Distance Maps are Built per Letter
+        parallel(num_letters, 1, [&](int first, int last)
+        {
+            ChamferModel model;
+            vector<uint64_t> letterbits(words);
+            vector<int> scores(numSamples);
+            for (int i = first; i < last; i++)
+            {
+                pack(i, 0, &letterbits[0]);
+                chamfer_model(&letterbits[0], size, size, model);
+                chamfer_scores(model, &bank.models[0], numSamples, numPixels,
+                    &scores[0]);
+                best_samples(bank, &scores[0], numPixels, numPixels,
+                    &stat[i * NUM_TEMPLATES]);
+                level[i] = 0;
+            }
+        });
+        return;
+    }
+
+    //Letters not Decided Yet
+    vector<int> pending(num_letters);
+    for (int i = 0; i < num_letters; i++)
+        pending[i] = i;
+
+    vector<int> scores;
+    for (int l = levels - 1; l >= 0 && !pending.empty(); l--)
+    {
+        int lsize = PYRAMID_SIZE(size, l);
+        int lpixels = lsize * lsize;
+        int lwords = WORDS_FOR(lpixels);
+        int count = pending.size();
+
+        //Packing and Matching of the Pending Letters, a Slice per Thread
+        bits.resize(count * lwords);
+        scores.resize(count * numSamples + 1);
+        parallel(count, MATCH_SLICE, [&](int first, int last)
+        {
+            for (int k = first; k < last; k++)
+                pack(pending[k], l, &bits[k * lwords]);
+            match_scores_batch(&bits[first * lwords], last - first,
+                &bank.bits[l][0], numSamples, lpixels,
+                &scores[first * numSamples]);
+        });
+
+        //Keeps the Letters with a Low Margin for the Next Level
+        int kept = 0;
+        for (int k = 0; k < count; k++)
+        {
+            int *out = &stat[pending[k] * NUM_TEMPLATES];
+            best_samples(bank, &scores[k * numSamples], numPixels, lpixels,
+                out);
+            level[pending[k]] = l;
+
+            Candidate top[2];
+            if (l > 0 &&
+                top_candidates(out, NUM_TEMPLATES, numPixels, top, 2) == 2 &&
+                top[0].norm - top[1].norm < margin)
+                pending[kept++] = pending[k];
+        }
+        pending.resize(kept);
+    }
+}
+
+/*
+* Turns the template scores of result into the word, the candidates and
+* the confidence.
+*/
+void OcrEngine::interpret(PlateResult &result, const int level[]) const
+{
+    int num_letters = result.num_letters;
+    result.word = "";
+
+    //Classes Allowed by the Plate Formats
+    int classes[MAX_LETTERS];
+    bool constrained = allowed_classes(grammar, num_letters, classes);
+
+    //Identification
+    for (int i = 0; i < num_letters; i++)
+    {
+        if (!constrained)
+            classes[i] = CLASS_ANY;
+        char ch = identifier(result.scores[i], classes[i], result.chars[i]);
+        result.chars[i].level = level[i];
+        result.word += ch;
+    }
+
+    //Format-Constrained Decoding
+    int decoded[MAX_LETTERS];
+    if (constrained &&
+        decode_plate(grammar, result.scores, num_letters, decoded))
+    {
+        result.word = "";
+        for (int i = 0; i < num_letters; i++)
+        {
+            result.word += converter(decoded[i]);
+        }
+    }
+
+    //Confidence of the Reading
+    result.confidence = plate_confidence(result.chars, num_letters);
+}
+
+/*
+* The scores of every template are already known, so restricting a letter
+* to the classes of its position only has to drop the other templates.
+*/
+char OcrEngine::identifier(int stat[], int classMask,
+    CharResult &result) const
+{
+    //Only Templates of the Allowed Classes are Kept
+    for (int i = 0; i < NUM_TEMPLATES; i++)
+    {
+        if (!(template_class(i) & classMask))
+            stat[i] = -1;
+    }
+
+    //Determination of the Best Candidates
+    result.count = top_candidates(stat, NUM_TEMPLATES, numPixels,
+        result.top, TOP_K);
+    result.confidence = char_confidence(result.top, result.count);
+
+    //Interpretation of Histogram Peak
+    return converter(result.top[0].index);
+}
+
+char OcrEngine::converter(int value)
+{
+    char val;
+    //Lowercase Letter
+    if(value > 35)
+    {
+        val = value+71;
+    }
+    //Numbers
+    else if(value > 25)
+    {
+        val = value+22;
+    }
+    //Uppercase Letter
+    else
+    {
+        val = value+65;
+    }
+    return val;
+}
+
+//Memory Functions
+long peak_memory_kb()
+{
+#if defined(__linux__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+        sizeof(counters)))
+        return counters.PeakWorkingSetSize / 1024;
+#endif
+    return -1;
+}
+
+//Supplementary Code
+//The best score of the samples of every template, scaled from the pixels
+//of a level to those of the full glyph
+void best_samples(const OcrBank &bank, const int scores[], int numPixels,
+    int lpixels, int stat[])
+{
+    for (int t = 0; t < NUM_TEMPLATES; t++)
+        stat[t] = -1;
+    for (size_t i = 0; i < bank.templates.size(); i++)
+    {
+        int score = (int)((long long)scores[i] * numPixels / lpixels);
+        if (score > stat[bank.templates[i]])
+            stat[bank.templates[i]] = score;
+    }
+}
+
+//Stores the time since start for the stage, if timed, and starts again
+void lap(double timings[], int stage, chrono::steady_clock::time_point &start)
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (timings != NULL)
+        timings[stage] = chrono::duration<double, micro>(now - start).count();
+    start = now;
+}
+
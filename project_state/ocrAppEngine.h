@@ -0,0 +1,287 @@
+/***************************************************************
+ * Name:      ocrAppEngine.h
+ * Purpose:   Defines the Recognition Engine shared by the GUI
+ *            and the Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPENGINE_H
+#define OCRAPPENGINE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "ocrImage.h"
+#include "ocrAppMatch.h"
+#include "ocrAppDecode.h"
+#include "ocrAppChamfer.h"
+#include "ocrAppPool.h"
+#include "ocrAppDeskew.h"
+#include "ocrAppMorph.h"
+#include "ocrAppPrepro.h"
+
+using namespace std;
+
+//Matchers
+#define MATCH_PIXELS 0  //Equal pixels of the glyph and the template
+#define MATCH_CHAMFER 1 //Distance between their edges (ocrAppChamfer.h)
+
+//Stages of a Recognition, as Timed in PlateResult
+#define STAGE_GRAY 0     //color_plane
+#define STAGE_BINARY 1   //threshold
+#define STAGE_PLATE 2    //segmentation of the plate
+#define STAGE_LETTERS 3  //segmentation_word and the glyphs
+#define STAGE_MATCH 4    //Scores and interpretation
+#define NUM_STAGES 5
+
+//Verdicts of the Quality Gate, as Kept in PlateResult
+#define GATE_PASSED 0    //Read as usual
+#define GATE_BLURRED 1   //Too little sharpness
+#define GATE_FLAT 2      //Too little spread of the gray levels
+#define GATE_LETTERS 3   //Too few or too many plausible letters
+#define NUM_GATES 4
+
+//Default Thresholds of the Gate, for the Best Channel. Every sample of
+//test_files that reads passes them, and none does once blurred over
+//3 x 3 pixels, which is already enough for threshold to lose the letters
+#define GATE_SHARPNESS 100  //Least variance of the Laplacian
+#define GATE_SPREAD 16      //Least gray levels from 1st to 99th percentile
+#define GATE_MIN_LETTERS 1
+#define GATE_ASPECT 4       //Letters wider than this many times their
+                            //height are bars or frames, not letters
+
+#define MAX_SAMPLES 8    //Samples kept per template by add_sample
+#define GLYPH_SLOTS 64   //Letters packed by recognize_stream before they
+                         //are matched together, at least MAX_LETTERS
+
+extern const char *const stage_names[NUM_STAGES];
+extern const char *const gate_names[NUM_GATES];
+
+//Reading of a whole plate
+struct PlateResult
+{
+    string word;                        //Interpretation
+    int num_letters;                    //Number of segmented letters
+    CharResult chars[MAX_LETTERS];      //Candidates and Scores per Letter
+    int scores[MAX_LETTERS][NUM_TEMPLATES]; //Template Scores per Letter
+    double confidence;                  //Confidence of the Whole Word
+    double timings[NUM_STAGES];         //Microseconds spent per Stage
+    int rejected;                       //GATE_PASSED, or why the Gate
+                                        //Skipped the Frame
+
+    PlateResult() : num_letters(0), confidence(0), rejected(GATE_PASSED) {}
+};
+
+//Thresholds of the quality gate (see OcrEngine::set_gate), 0 for a
+//test that is not made
+struct GateOptions
+{
+    double sharpness;   //Least variance of the Laplacian of the gray frame
+    int spread;         //Least gray levels from its 1st to 99th percentile
+    int min_letters;    //Least and most plausible letters of the plate
+    int max_letters;
+
+    GateOptions();
+};
+
+/*
+* The templates as they are matched. A template (a class of letter, see
+* OcrEngine::converter) has any number of samples, and a letter scores
+* the best of the samples of each template, so PlateResult keeps one
+* score per template whatever the samples. A bank is never changed once
+* the engine has published it.
+*/
+struct OcrBank
+{
+    int size;                        //Glyph size it was built at
+    vector<OcrImage> samples;        //Samples, Cropped to the Letters
+    vector<OcrBitmap> packed;        //The same with 1 bit per pixel,
+                                     //instead of samples when compact
+    vector<int> templates;           //Template of every Sample
+    vector<uint64_t> bits[PYRAMID_LEVELS]; //Samples with 1 bit per pixel,
+                                     //per Pyramid Level
+    vector<ChamferModel> models;     //Edges and Distance Maps, left empty
+                                     //when compact but for MATCH_CHAMFER
+};
+
+/*
+* The engine holds everything that is loaded once at startup (the
+* training set and the plate formats). After train() it is only read,
+* so one engine can serve recognitions from several threads at once.
+* The templates alone may change while it serves: every change builds a
+* new bank and publishes it atomically, and a recognition keeps the bank
+* it started with, so neither side ever waits for the other.
+*/
+class OcrEngine
+{
+public:
+    OcrEngine();
+
+    //Loading Functions
+    //Training images of the templates are found by template_file
+    bool train(const string &dir);
+    void train(const OcrImage images[]);
+    static string template_file(const string &dir, int index);
+    bool load_formats(const string &filename);
+
+    //Online Training Functions
+    //Safe while other threads recognize. Samples are letter images, as
+    //for train(), and index is a template. Returns false for an invalid
+    //index or image
+    //Adds a sample, dropping the oldest after the first of the template
+    //beyond MAX_SAMPLES
+    bool add_sample(int index, const OcrImage &image);
+    //Makes the image the only sample of the template
+    bool replace_samples(int index, const OcrImage &image);
+    //Removes every sample of the template, which then never matches.
+    //The last template with samples is not removed
+    bool remove_samples(int index);
+    int sample_count(int index) const;
+    //Folds the confirmed reading of a plate into the bank: every letter
+    //the result read as another character becomes a sample of the
+    //confirmed one. letters are the glyphs segment() gave for result.
+    //Returns the samples added, -1 if confirmed has another length
+    int learn(const OcrImage letters[], const PlateResult &result,
+        const string &confirmed);
+    //The bank recognitions started now would use
+    shared_ptr<const OcrBank> templates() const;
+    //The template of a character, -1 if there is none (see converter)
+    static int template_index(char ch);
+    void set_matcher(int matcher);
+    //Width and height of the normalized glyphs, GLYPH_LARGE by default.
+    //Smaller glyphs are faster to match but easier to confuse. Sizes
+    //other than those of glyph_sizes work with the generic kernels
+    bool set_glyph_size(int size);
+    int glyph_size() const;
+    //Matches on the first levels of the glyph pyramid, coarsest first,
+    //going to a finer level only for letters whose two best templates
+    //are less than margin apart (as a fraction of the pixels). 1 level
+    //is the full glyph only. Only the pixel matcher uses the pyramid
+    bool set_pyramid(int levels, double margin);
+    //Straightens plates rotated or slanted by up to degrees (at most
+    //MAX_SKEW) before they are cropped, DESKEW_DEGREES by default. 0
+    //leaves every plate as it is
+    bool set_deskew(int degrees);
+    int deskew_limit() const;
+    //Removes specks, frames and cracks from the thresholded plate with
+    //clean_binary before it is straightened and cropped, on by default
+    void set_cleanup(bool enabled);
+    bool cleanup_enabled() const;
+    //Changes whenever a setting changes what crop_plate gives
+    long plate_revision() const;
+    //Memory budget mode, off by default: the bank keeps its samples with
+    //1 bit per pixel, and chamfer models only for the chamfer matcher,
+    //and recognize_batch goes through recognize_stream. Readings are the
+    //same either way
+    void set_compact(bool enabled);
+    bool compact_enabled() const;
+    //Quality gate, off by default. When on, segment() first measures a
+    //sixteenth of the color frame and stops there when it is blurred or
+    //flat, before color_plane and threshold pass over it; else it counts
+    //the plausible letters of the plate before making their glyphs. A
+    //frame the gate turns down reads no letters, in a few hundred
+    //microseconds rather than the milliseconds of a recognition
+    void set_gate(bool enabled, const GateOptions &options = GateOptions());
+    bool gate_enabled() const;
+    //Bytes of the bank recognitions started now would use
+    size_t bank_bytes() const;
+    //Spreads plates, letters and their matching over the pool (not
+    //owned), or keeps everything on the calling thread if NULL
+    void set_pool(OcrPool *pool);
+    //Changes whenever training or a setting changes what identify gives
+    long revision() const;
+
+    //Recognition Functions
+    //Filters the image in place and cuts it into letters, timing the
+    //stages before STAGE_MATCH if timings is given, and telling the
+    //verdict of the gate if rejected is
+    int segment(OcrImage &image, OcrImage letters[],
+        double timings[] = NULL, int *rejected = NULL) const;
+    //The stages of segment(), for callers that keep every image
+    void to_gray(OcrImage &image) const;
+    void to_binary(OcrImage &image) const;
+    void crop_plate(OcrImage &image) const;
+    int split_letters(const OcrView &plate, OcrImage letters[]) const;
+    //Cleans and straightens the thresholded image in place, and returns
+    //the window of it that crop_plate copies out, valid while the image
+    //is not changed
+    OcrView find_plate(OcrImage &image) const;
+    //Identifies already segmented letters. Of the timings, only
+    //STAGE_MATCH is set
+    void identify(const OcrImage letters[], int num_letters,
+        PlateResult &result) const;
+    //Both of the above on a copy of the image
+    void recognize(const OcrImage &image, PlateResult &result) const;
+    //Recognizes several plates, scoring all of their letters at once
+    void recognize_batch(const OcrImage images[], int num_images,
+        PlateResult results[]) const;
+    //Recognizes num_images plates that load decodes one at a time, so
+    //only one frame is ever kept: its letters are packed into
+    //GLYPH_SLOTS slots as soon as they are cut, and matched whenever the
+    //slots are full. A plate that load cannot give reads no letters
+    void recognize_stream(int num_images,
+        const function<bool(int index, OcrImage &image)> &load,
+        PlateResult results[]) const;
+
+    char identifier(int stat[], int classMask, CharResult &result) const;
+    //The character of a template (see template_index)
+    static char converter(int value);
+
+private:
+    //Recognition Functions
+    void pack_letter(const OcrImage &letter, int level,
+        uint64_t bits[]) const;
+    void score_letters(const OcrImage letters[], int num_letters,
+        int stat[], int level[]) const;
+    void score_glyphs(int num_letters,
+        const function<void(int letter, int level, uint64_t bits[])> &pack,
+        int stat[], int level[]) const;
+    void interpret(PlateResult &result, const int level[]) const;
+    bool update(const function<bool(OcrBank &bank)> &change);
+    void build_bank(OcrBank &bank) const;
+    void build_sample(OcrBank &bank, int sample) const;
+    void insert_sample(OcrBank &bank, int index,
+        const OcrImage &sample) const;
+    void erase_sample(OcrBank &bank, int sample) const;
+    void refresh();
+    void complete(OcrBank &bank) const;
+    bool completed(const OcrBank &bank) const;
+    bool keeps_models() const;
+    static OcrImage sample_image(const OcrBank &bank, int sample);
+    void prepare_sample(OcrImage &image) const;
+    void parallel(int count, int grain,
+        const function<void(int, int)> &body) const;
+    void make_glyphs(const OcrView windows[], int num_letters,
+        OcrImage letters[]) const;
+    int judge_frame(const FrameQuality &quality) const;
+    int judge_letters(const OcrView windows[], int num_letters) const;
+
+    //Variables
+    shared_ptr<const OcrBank> bank;  //Templates, Read with atomic_load
+    mutex updates;                   //Serializes the Changes of the Bank
+    int matcher;                     //MATCH_PIXELS or MATCH_CHAMFER
+    int size;                        //Width and height of a glyph
+    int numPixels;                   //Pixels of a letter and a template
+    int words;                       //64-bit words of a packed letter
+    int levels;                      //Pyramid Levels used for Matching
+    double margin;                   //Margin Accepted at a Coarse Level
+    int skew;                        //Largest Skew Straightened, Degrees
+    bool cleanup;                    //Morphological Cleanup of Plates
+    bool compact;                    //Memory Budget Mode
+    bool gate;                       //Quality Gate
+    GateOptions gateOptions;
+    PlateGrammar grammar;            //Accepted Plate Formats
+    OcrPool *pool;                   //Threads for the Recognition
+    atomic<long> revisions;          //Changes of the Training and Settings
+    long plateRevisions;             //Changes of the Settings of crop_plate
+};
+
+//Memory Functions
+//Largest resident memory of the process so far, in KB, -1 if unknown
+long peak_memory_kb();
+
+#endif
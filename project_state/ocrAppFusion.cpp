@@ -0,0 +1,273 @@
+/***************************************************************
+ * Name:      ocrAppFusion.cpp
+ * Purpose:   Code for the Fusion of the Readings of a Vehicle over
+ *            Consecutive Frames
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppFusion.h"
+#include <map>
+#include <algorithm>
+
+using namespace std;
+
+//Definitions
+#define GAP NUM_TEMPLATES   //Vote of a frame that misses a position
+
+//Functions
+double char_weight(const PlateResult &result, int position);
+char char_rival(const PlateResult &result, int position, double &share);
+void align_reading(const string &word, const string &reference,
+    int aligned[]);
+
+OcrTrack::OcrTrack(double threshold, int maxFrames)
+    : threshold(threshold), maxFrames(maxFrames)
+{
+    reset();
+}
+
+bool OcrTrack::add(const PlateResult &result)
+{
+    seen++;
+    if (result.rejected == GATE_PASSED && result.num_letters > 0 &&
+        (int)result.word.size() == result.num_letters)
+    {
+        Frame frame;
+        frame.word = result.word;
+        frame.total = 0;
+        for (int i = 0; i < result.num_letters; i++)
+        {
+            double share;
+            frame.weights.push_back(char_weight(result, i));
+            frame.rivals += char_rival(result, i, share);
+            frame.shares.push_back(share);
+            frame.total += frame.weights.back();
+        }
+        readings.push_back(frame);
+        tally();
+    }
+    return decided();
+}
+
+void OcrTrack::reset()
+{
+    readings.clear();
+    seen = 0;
+    consensus = "";
+    consensusConfidence = 0;
+}
+
+const string &OcrTrack::word() const
+{
+    return consensus;
+}
+
+double OcrTrack::confidence() const
+{
+    return consensusConfidence;
+}
+
+int OcrTrack::frames() const
+{
+    return seen;
+}
+
+bool OcrTrack::decided() const
+{
+    return seen >= maxFrames ||
+        (!consensus.empty() && consensusConfidence >= threshold);
+}
+
+/*
+* The frames are few (a track is decided after FUSION_FRAMES at most) and
+* short, so the votes are counted again from every reading whenever one
+* is added, rather than kept aligned to a reference that may change.
+*/
+void OcrTrack::tally()
+{
+    //Length Read by Most of the Weight, a Frame Weighing its Mean Score
+    map<size_t, double> lengths;
+    for (size_t f = 0; f < readings.size(); f++)
+        lengths[readings[f].word.size()] +=
+            readings[f].total / readings[f].word.size();
+    size_t length = 0;
+    double heaviest = -1;
+    for (map<size_t, double>::iterator it = lengths.begin();
+        it != lengths.end(); ++it)
+    {
+        if (it->second > heaviest)
+        {
+            heaviest = it->second;
+            length = it->first;
+        }
+    }
+
+    //Reference: the Heaviest Reading of that Length
+    size_t reference = 0;
+    heaviest = -1;
+    for (size_t f = 0; f < readings.size(); f++)
+    {
+        if (readings[f].word.size() == length &&
+            readings[f].total > heaviest)
+        {
+            heaviest = readings[f].total;
+            reference = f;
+        }
+    }
+    const string &ref = readings[reference].word;
+
+    //Votes of the Aligned Frames
+    vector<double> votes(length * (NUM_TEMPLATES + 1), 0);
+    char letters[NUM_TEMPLATES];
+    int aligned[MAX_LETTERS];
+    for (size_t f = 0; f < readings.size(); f++)
+    {
+        const Frame &frame = readings[f];
+        align_reading(frame.word, ref, aligned);
+        for (size_t j = 0; j < length; j++)
+        {
+            double *vote = &votes[j * (NUM_TEMPLATES + 1)];
+            int a = aligned[j];
+            int index = a < 0 ? -1 :
+                OcrEngine::template_index(frame.word[a]);
+            if (index < 0)
+            {
+                vote[GAP] += frame.total / frame.word.size();
+                continue;
+            }
+            vote[index] += frame.weights[a] * frame.shares[a];
+            letters[index] = frame.word[a];
+            int rival = OcrEngine::template_index(frame.rivals[a]);
+            if (rival >= 0)
+            {
+                vote[rival] += frame.weights[a] * (1 - frame.shares[a]);
+                letters[rival] = frame.rivals[a];
+            }
+        }
+    }
+
+    //Best Character of every Position, and its Lead
+    consensus = "";
+    consensusConfidence = 1;
+    for (size_t j = 0; j < length; j++)
+    {
+        const double *vote = &votes[j * (NUM_TEMPLATES + 1)];
+        int best = GAP;
+        double first = 0, second = 0, total = 0;
+        for (int t = 0; t <= NUM_TEMPLATES; t++)
+        {
+            total += vote[t];
+            if (vote[t] > first)
+            {
+                second = first;
+                first = vote[t];
+                best = t;
+            }
+            else if (vote[t] > second)
+                second = vote[t];
+        }
+        double lead = (first - second) / (total + FUSION_PRIOR);
+        if (lead < consensusConfidence)
+            consensusConfidence = lead;
+        //A Position most Frames Miss is not a Letter
+        if (best != GAP && first > 0)
+            consensus += letters[best];
+    }
+    if (consensus.empty())
+        consensusConfidence = 0;
+}
+
+//Supplementary Code
+/*
+* The match score of the character the frame read. It is usually its best
+* candidate; when the plate formats made it read another one, the score
+* is taken from those of every template, in the same units.
+*/
+double char_weight(const PlateResult &result, int position)
+{
+    const CharResult &letter = result.chars[position];
+    int index = OcrEngine::template_index(result.word[position]);
+    for (int k = 0; k < letter.count; k++)
+    {
+        if (letter.top[k].index == index)
+            return letter.top[k].norm;
+    }
+    if (index < 0 || letter.count == 0 || letter.top[0].score <= 0 ||
+        result.scores[position][index] <= 0)
+        return 0;
+    return result.scores[position][index] * letter.top[0].norm /
+        letter.top[0].score;
+}
+
+/*
+* The candidate the character read was weighed against, and the share of
+* the vote the character keeps: (1 + confidence) / 2 when it was the best
+* candidate, so a coin flip splits the vote evenly, and the rest when the
+* plate formats made the frame read another one. A letter without rival
+* keeps the whole vote.
+*/
+char char_rival(const PlateResult &result, int position, double &share)
+{
+    const CharResult &letter = result.chars[position];
+    int index = OcrEngine::template_index(result.word[position]);
+    double confidence = min(max(letter.confidence, 0.0), 1.0);
+    share = 1;
+    if (letter.count == 0)
+        return 0;
+    if (letter.top[0].index != index)
+    {
+        share = (1 - confidence) / 2;
+        return OcrEngine::converter(letter.top[0].index);
+    }
+    if (letter.count < 2)
+        return 0;
+    share = (1 + confidence) / 2;
+    return OcrEngine::converter(letter.top[1].index);
+}
+
+/*
+* Levenshtein alignment, every edit costing 1. aligned[j] is the letter of
+* word that stands for reference[j], or -1 where word misses it; ties go
+* to substitutions, so words of the same length align letter for letter.
+*/
+void align_reading(const string &word, const string &reference,
+    int aligned[])
+{
+    int n = word.size(), m = reference.size();
+    vector<int> cost((n + 1) * (m + 1));
+    for (int i = 0; i <= n; i++)
+    {
+        for (int j = 0; j <= m; j++)
+        {
+            int c;
+            if (i == 0 || j == 0)
+                c = i + j;
+            else
+            {
+                c = cost[(i - 1) * (m + 1) + j - 1] +
+                    (word[i - 1] != reference[j - 1]);
+                c = min(c, cost[(i - 1) * (m + 1) + j] + 1);
+                c = min(c, cost[i * (m + 1) + j - 1] + 1);
+            }
+            cost[i * (m + 1) + j] = c;
+        }
+    }
+
+    //Back from the End
+    int i = n, j = m;
+    while (j > 0)
+    {
+        int here = cost[i * (m + 1) + j];
+        if (i > 0 && here == cost[(i - 1) * (m + 1) + j - 1] +
+            (word[i - 1] != reference[j - 1]))
+        {
+            aligned[--j] = --i;
+        }
+        else if (i > 0 && here == cost[(i - 1) * (m + 1) + j] + 1)
+            i--;
+        else
+            aligned[--j] = -1;
+    }
+}
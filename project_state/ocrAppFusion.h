@@ -0,0 +1,87 @@
+/***************************************************************
+ * Name:      ocrAppFusion.h
+ * Purpose:   Defines the Fusion of the Readings of a Vehicle over
+ *            Consecutive Frames
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPFUSION_H
+#define OCRAPPFUSION_H
+
+#include <string>
+#include <vector>
+#include "ocrAppEngine.h"
+
+using namespace std;
+
+//Definitions
+#define FUSION_CONFIDENCE 0.75 //Consensus at which a track is decided
+#define FUSION_FRAMES 16       //Frames after which it is decided anyway
+#define FUSION_PRIOR 1.0       //Weight of the doubt before any frame, about
+                               //that of one frame, so that a single frame
+                               //is never more than half sure
+
+/*
+* The readings of one vehicle over consecutive frames, fused into one.
+* Every frame votes at every position with the match score of the
+* character it read (0 to 1), so a clear glyph counts for more than a
+* smudged one, which matches every template poorly. The vote is shared
+* with the runner-up by the confidence of the letter: a clear winner
+* keeps all of it, a coin flip between O and 0 gives each half, and any
+* number of such frames never settles the position.
+*
+* The frames need not agree on the number of letters: the length most of
+* the weight read is taken, and every frame is aligned to the heaviest
+* reading of that length by edit distance. A letter the frame has over
+* the reference is dropped, and a letter it misses votes for a gap.
+*
+* The confidence of a position is the lead of its best character over the
+* next one, over all the weight of the position and FUSION_PRIOR; that of
+* the track is the lowest of its positions, as for a single plate. Once it
+* reaches the threshold, or FUSION_FRAMES frames were added, the track is
+* decided and the frames still to come need not be recognized.
+*/
+class OcrTrack
+{
+public:
+    OcrTrack(double threshold = FUSION_CONFIDENCE,
+        int maxFrames = FUSION_FRAMES);
+
+    //Adds the reading of the next frame, returns decided(). Frames the
+    //gate turned down or that read no letters add no votes, but count
+    //as frames
+    bool add(const PlateResult &result);
+    void reset();
+
+    //Consensus of the frames so far, empty before any of them read
+    const string &word() const;
+    double confidence() const;
+    int frames() const;
+    bool decided() const;
+
+private:
+    //A Reading as it is Kept
+    struct Frame
+    {
+        string word;
+        vector<double> weights;   //Match Score of every Character
+        vector<double> shares;    //Part of it for the Character Read
+        string rivals;            //Runner-up of every Character, or 0
+        double total;
+    };
+
+    //Fusion Functions
+    void tally();
+
+    //Variables
+    double threshold;
+    int maxFrames;
+    vector<Frame> readings;       //Frames that Read Letters
+    int seen;                     //Every Frame Added
+    string consensus;
+    double consensusConfidence;
+};
+
+#endif
@@ -0,0 +1,149 @@
+/***************************************************************
+ * Name:      ocrAppHistogram.cpp
+ * Purpose:   Code for the High Dynamic Range Histogram of Latencies
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppHistogram.h"
+#include <math.h>
+
+using namespace std;
+
+/*
+* With 2^(halfBits+1) sub-buckets, bucket b holds the values from
+* 2^(halfBits+b) up with a step of 2^b; bucket 0 also holds the values
+* below, with a step of 1. Only the upper half of every bucket but the
+* first is stored, the lower half being the bucket before it, so the
+* counts are (buckets + 1) halves of 2^halfBits.
+*/
+OcrHistogram::OcrHistogram(int64_t highest, int digits)
+    : highest(highest < 2 ? 2 : highest)
+{
+    //Sub-Buckets for a Step of at most 10^-digits of the Value
+    int64_t needed = 2;
+    for (int i = 0; i < digits; i++)
+        needed *= 10;
+    int bits = 1;
+    while (((int64_t)1 << bits) < needed)
+        bits++;
+    halfBits = bits - 1;
+
+    //Buckets up to Highest
+    int buckets = 1;
+    int64_t reach = (int64_t)1 << bits;
+    while (reach <= this->highest)
+    {
+        reach <<= 1;
+        buckets++;
+    }
+    counts.resize((size_t)(buckets + 1) << halfBits);
+    reset();
+}
+
+void OcrHistogram::record(int64_t value)
+{
+    if (value < 0)
+        value = 0;
+    if (value > highest)
+        value = highest;
+    counts[index_of(value)]++;
+    if (total == 0 || value < smallest)
+        smallest = value;
+    if (value > largest)
+        largest = value;
+    total++;
+    sum += (double)value;
+}
+
+void OcrHistogram::merge(const OcrHistogram &other)
+{
+    if (other.counts.size() != counts.size() || other.total == 0)
+        return;
+    for (size_t i = 0; i < counts.size(); i++)
+        counts[i] += other.counts[i];
+    if (total == 0 || other.smallest < smallest)
+        smallest = other.smallest;
+    if (other.largest > largest)
+        largest = other.largest;
+    total += other.total;
+    sum += other.sum;
+}
+
+void OcrHistogram::reset()
+{
+    for (size_t i = 0; i < counts.size(); i++)
+        counts[i] = 0;
+    total = 0;
+    smallest = 0;
+    largest = 0;
+    sum = 0;
+}
+
+int64_t OcrHistogram::count() const
+{
+    return total;
+}
+
+int64_t OcrHistogram::min() const
+{
+    return smallest;
+}
+
+int64_t OcrHistogram::max() const
+{
+    return largest;
+}
+
+double OcrHistogram::mean() const
+{
+    return total ? sum / total : 0;
+}
+
+int64_t OcrHistogram::percentile(double percent) const
+{
+    if (total == 0)
+        return 0;
+    if (percent > 100)
+        percent = 100;
+    int64_t wanted = (int64_t)ceil(percent / 100 * total);
+    if (wanted < 1)
+        wanted = 1;
+
+    int64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        seen += counts[i];
+        if (seen >= wanted)
+        {
+            int64_t value = highest_at((int)i);
+            return value < largest ? value : largest;
+        }
+    }
+    return largest;
+}
+
+int OcrHistogram::index_of(int64_t value) const
+{
+    //Bucket: Bits of the Value beyond those of the Sub-Buckets
+    int64_t half = (int64_t)1 << halfBits;
+    int bucket = 0;
+    for (int64_t v = value >> (halfBits + 1); v; v >>= 1)
+        bucket++;
+    int64_t sub = value >> bucket;
+    return (int)(((int64_t)(bucket + 1) << halfBits) + sub - half);
+}
+
+int64_t OcrHistogram::highest_at(int index) const
+{
+    int64_t half = (int64_t)1 << halfBits;
+    int bucket = (index >> halfBits) - 1;
+    int64_t sub = (index & (half - 1)) + half;
+    if (bucket < 0)
+    {
+        sub -= half;
+        bucket = 0;
+    }
+    return (sub << bucket) + ((int64_t)1 << bucket) - 1;
+}
@@ -0,0 +1,67 @@
+/***************************************************************
+ * Name:      ocrAppHistogram.h
+ * Purpose:   Defines the High Dynamic Range Histogram of Latencies
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPHISTOGRAM_H
+#define OCRAPPHISTOGRAM_H
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+//Definitions
+#define HISTOGRAM_HIGHEST 3600000000LL //Largest value kept, an hour in us
+#define HISTOGRAM_DIGITS 3             //Significant decimal digits kept
+
+/*
+* A histogram of values from 0 to a highest one, laid out as HdrHistogram
+* does: the values are split into buckets of powers of two, and every
+* bucket into the same number of sub-buckets, enough for the significant
+* digits asked for. A value is thus kept to the same relative precision
+* whatever its size (1 us as well as 10 s) in under 200 KB, and
+* recording it only computes an index.
+*
+* A histogram is not safe to record into from several threads at once;
+* keep one per thread and merge them, or hold a lock.
+*/
+class OcrHistogram
+{
+public:
+    OcrHistogram(int64_t highest = HISTOGRAM_HIGHEST,
+        int digits = HISTOGRAM_DIGITS);
+
+    //Values above highest are kept as highest, below 0 as 0
+    void record(int64_t value);
+    //Adds the values of a histogram of the same highest and digits
+    void merge(const OcrHistogram &other);
+    void reset();
+
+    int64_t count() const;
+    int64_t min() const;
+    int64_t max() const;
+    double mean() const;
+    //Largest value (to the precision kept) that percent of the values
+    //are at or below, 0 for an empty histogram
+    int64_t percentile(double percent) const;
+
+private:
+    //Histogram Functions
+    int index_of(int64_t value) const;
+    int64_t highest_at(int index) const;
+
+    //Variables
+    int64_t highest;
+    int halfBits;          //log2 of half the sub-buckets of a bucket
+    vector<int64_t> counts;
+    int64_t total;
+    int64_t smallest;
+    int64_t largest;
+    double sum;
+};
+
+#endif
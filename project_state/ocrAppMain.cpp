@@ -7,28 +7,34 @@
  * License:
  **************************************************************/
 #include "ocrAppMain.h"
-#include "ocrAppPrepro.h"
 #include <iostream>
-#include <fstream>
 
 using namespace std;
 
 //GUI Operations
+MyFrame::~MyFrame()
+{
+    //Jobs Still Queued Return at Once
+    cancel();
+}
 void MyFrame::OnExit(wxCommandEvent& event)
 {
     Close( true );
 }
 void MyFrame::OnSave(wxCommandEvent& event)
 {
-    if (loaded == 1 && edited == 1)
+    //Readings are Appended to the Log, with their Scores and Timings
+    if (loaded == 1 && identified == 1)
     {
-        ofstream myfile ("output.txt");
-        if (myfile.is_open())
+        if (!results.is_open() && !results.open("results.jsonl", ""))
         {
-            myfile << word + "\n";
-            myfile.close();
-            label->SetLabel("Saved");
-        }  
+            SetStatusText("Cannot open results.jsonl");
+            return;
+        }
+        OcrRecord record;
+        make_record(engine, source, *plate, record);
+        results.write(record);
+        label->SetLabel("Saved");
     }
 }
 void MyFrame::OnAbout(wxCommandEvent& event)
@@ -54,36 +60,37 @@ void MyFrame::Clear(wxCommandEvent& event)
         }
     }
     WxStaticBitmap1->SetBitmap(temp);
-    edited = 0;
+    cancel();
+    identified = 0;
     loaded = 0;
 }
 
 //Image Panel Functions
 void MyFrame::viewnext(wxCommandEvent& event)
 {
-    if (loaded == 1 && edited == 1)
+    if (loaded == 1 && identified == 1 && num_letters > 0)
     {
         viewnow++;
-        if(viewnow == num_letters)
+        if(viewnow >= num_letters)
             viewnow = 0;
-        WxStaticBitmap1->SetBitmap(theinputs[viewnow].Scale(W,H));
+        show_letter(viewnow);
     }
 }
 void MyFrame::viewprev(wxCommandEvent& event)
 {
-    if (loaded == 1 && edited == 1)
+    if (loaded == 1 && identified == 1 && num_letters > 0)
     {
         viewnow--;
-        if(viewnow == -1)
+        if(viewnow < 0)
             viewnow = num_letters - 1;
-        WxStaticBitmap1->SetBitmap(theinputs[viewnow].Scale(W,H));
+        show_letter(viewnow);
     }
 }
 void MyFrame::backtoimg(wxCommandEvent& event)
 {
     if (loaded == 1)
     {
-        WxStaticBitmap1->SetBitmap(input.Scale(W,H));
+        show_input();
     }
 }
 
@@ -94,133 +101,209 @@ void MyFrame::OnLoad(wxCommandEvent& event)
     FileDialog1->ShowModal();
     if (FileDialog1->GetPath().IsEmpty()) return;
     
+    //A Reading of the Previous Image is of no Use Anymore
+    cancel();
+    
     //File Loading
     input.LoadFile(FileDialog1->GetPath(), wxBITMAP_TYPE_ANY);
+    source = FileDialog1->GetPath().ToStdString();
     //display the image 
-    WxStaticBitmap1->SetBitmap(input.Scale(W,H)); 
+    inputview = wxBitmap();
+    show_input();
+    
+    //The Stages of the Last Image are Dropped by the Worker
+    OcrImage image = to_ocr(input);
+    worker.submit([this, image]{ pipeline.set_source(image); });
 
     //For Error Handling
     loaded = 1;
-    edited = 0;   
+    identified = 0;   
 }
+//Runs on the worker, started by the constructor
 void MyFrame::train()
 {
-    int count = 11;
     //Loads Images
-    for (int i=0; i<52; i++)
+    //wxImage reads every format, so the core does not need its decoders
+    progress(generation, "Training...");
+    OcrImage images[NUM_TEMPLATES];
+    bool missing = 0;
+    for (int i=0; i<NUM_TEMPLATES; i++)
     {
-        //Converts int to string
-        string cnt;         
-        stringstream cnter;
-        cnter << count;
-        cnt = cnter.str();
-        
-        //Loads Image
-        trainset[i].LoadFile("trainset\\img0" + cnt + "-00986.png",
-            wxBITMAP_TYPE_ANY);
-        count++;
-        
-        //Apply Corresponding Filters
-        grayscale(trainset[i]);
-        threshold(trainset[i], 1);
-        segmentation(trainset[i]); 
-        trainset[i].Rescale(W/5,H/5);
+        wxImage image;
+        if (!image.LoadFile(OcrEngine::template_file("trainset", i),
+            wxBITMAP_TYPE_ANY))
+        {
+            missing = 1;
+        }
+        images[i] = to_ocr(image);
     }
+    engine.train(images);
+    engine.load_formats("grammar.txt");
+    
+    CallAfter([this, missing]
+    {
+        SetStatusText(missing ? "Some training images could not be loaded"
+            : "Ready");
+    });
 }
 
 //Recognition Functions
 void MyFrame::Identify(wxCommandEvent& event)
 {
+    if (loaded == 0)
+        return;
+    if (busy == 1)
+    {
+        SetStatusText("Still identifying...");
+        return;
+    }
     word = "";
-    if (loaded == 1)
+    busy = 1;
+    
+    //The Job Only Holds what the Pipeline Gives Back
+    shared_ptr<Reading> job(new Reading);
+    job->generation = generation;
+    
+    worker.submit([this, job]
     {
         //Apply Filters and Manipulations on Image
-        if (edited == 0)
-        {
-            grayscale(input);
-            threshold(input, 0);
-            segmentation(input);
-            num_letters = segmentation_word(input, theinputs);
-            for (int a = 0; a< num_letters; a++)
-            {
-                segmentation(theinputs[a]);
-                theinputs[a].Rescale(W/5,H/5);
-            }
-            WxStaticBitmap1->SetBitmap(input.Scale(W,H));
-            edited = 1;
-        }
+        //Stages made by an earlier Identify of the image are reused
+        if (job->generation != generation)
+            return;
+        progress(job->generation, "Segmenting...");
+        job->binary = pipeline.binary();
+        if (job->generation != generation)
+            return;
+        job->glyphs = pipeline.glyphs();
         
         //Identification
-        for (int i = 0; i < num_letters; i++)
-        {
-            stringstream ss;
-            string str;
-            char ch = identifier(theinputs[i]);
-            ss << ch;
-            ss >> str;
-            word.append(str);
-        }
-        label->SetLabel(word);
-    }
+        if (job->generation != generation)
+            return;
+        progress(job->generation, "Matching...");
+        job->result = pipeline.result();
+        CallAfter([this, job]{ finish(job); });
+    });
 }
 
-char MyFrame::identifier(wxImage &image)
+//Takes the Result of a Job, on the Event Loop
+void MyFrame::finish(const shared_ptr<Reading> &job)
 {
-    int red, red1;
-    int stat[52];
-    int sort_stat[52];
-    int maxindent = 0;
+    if (job->generation != generation)
+        return;
+    busy = 0;
     
-    //Generation of Histogram
-    for(int i=0; i<52; i++)
+    //The Matcher Changed while it was Read, so its Reading is Stale
+    if (again == 1)
     {
-        stat[i] = 0;
-        for (int x = 0; x < image.GetWidth(); x++)
-        {
-            for (int y = 0; y < image.GetHeight(); y++)
-            {
-                red = image.GetRed(x,y);
-                red1 = trainset[i].GetRed(x,y);
-                if(red == red1)
-                {
-                    stat[i]++;
-                }
-            }
-        }
+        again = 0;
+        wxCommandEvent event;
+        Identify(event);
+        return;
     }
-    
-    //Determination of Peak
-    for (int i=0; i<52; i++)
+    if (job->glyphs == NULL || job->result == NULL)
+        return;
+    if (job->binary != binary)
     {
-        sort_stat[i] = stat[i];
+        binary = job->binary;
+        binaryview = wxBitmap();
     }
-    qsort(sort_stat, 52, sizeof(int), compare);
+    if (job->glyphs != letters)
+    {
+        letters = job->glyphs;
+        num_letters = letters->num_letters;
+        for (int i = 0; i < num_letters; i++)
+            letterviews[i] = wxBitmap();
+        viewnow = -1;
+    }
+    show_binary();
+    identified = 1;
+    
+    plate = job->result;
+    word = plate->word;
+    label->SetLabel(word);
+    
+    //Confidence of the Reading
+    SetStatusText(wxString::Format("Confidence: %.2f", plate->confidence));
+}
+
+void MyFrame::OnChamfer(wxCommandEvent& event)
+{
+    //Changed between Jobs, Never during One
+    int matcher = event.IsChecked() ? MATCH_CHAMFER : MATCH_PIXELS;
+    worker.submit([this, matcher]{ engine.set_matcher(matcher); });
     
-    //Interpretation of Histogram Peak    
-    char cnt; 
-    for (int i = 0; i < 52; i++)
+    //Read Again with the Letters Already Cut; a job in flight was
+    //queued before the new matcher, so it is read again when it lands
+    if (busy == 1)
+        again = 1;
+    else if (loaded == 1 && identified == 1)
+        Identify(event);
+}
+
+//Background Functions
+//Called by the worker; the event is delivered on the event loop
+void MyFrame::progress(int job, const wxString &text)
+{
+    wxThreadEvent *event = new wxThreadEvent(EVT_OCR_PROGRESS);
+    event->SetInt(job);
+    event->SetString(text);
+    wxQueueEvent(this, event);
+}
+void MyFrame::OnProgress(wxThreadEvent& event)
+{
+    if (event.GetInt() == generation)
+        SetStatusText(event.GetString());
+}
+void MyFrame::cancel()
+{
+    generation++;
+    busy = 0;
+    again = 0;
+}
+
+//Preview Functions
+//Scaled to the panel only when shown, and then kept until the image changes
+void MyFrame::show_input()
+{
+    if (!inputview.IsOk())
+        inputview = wxBitmap(input.Scale(W,H));
+    WxStaticBitmap1->SetBitmap(inputview);
+}
+void MyFrame::show_binary()
+{
+    if (!binaryview.IsOk())
+        binaryview = wxBitmap(to_wx(*binary).Scale(W,H));
+    WxStaticBitmap1->SetBitmap(binaryview);
+}
+void MyFrame::show_letter(int index)
+{
+    if (!letterviews[index].IsOk())
     {
-        if(sort_stat[51] == stat[i])
-        {
-            maxindent = i;
-        }
+        letterviews[index] =
+            wxBitmap(to_wx(letters->letters[index]).Scale(W,H));
     }
-    cnt = converter(maxindent);
-    return cnt;
+    WxStaticBitmap1->SetBitmap(letterviews[index]);
 }
 
-char MyFrame::converter(int value)
+//Conversion Functions
+//The recognition core has its own image type, see ocrImage.h
+OcrImage MyFrame::to_ocr(const wxImage &image)
 {
-    char val;
-    //Numbers
-    if(value > 25)
+    OcrImage result;
+    if (image.IsOk() && result.Create(image.GetWidth(), image.GetHeight()))
     {
-        val = value+22; 
+        memcpy(result.GetData(), image.GetData(), 
+            image.GetWidth() * image.GetHeight() * 3);
     }
-    //Uppercase Letter
-    else
+    return result;
+}
+wxImage MyFrame::to_wx(const OcrImage &image)
+{
+    wxImage result;
+    if (image.IsOk() && result.Create(image.GetWidth(), image.GetHeight()))
     {
-        val = value+65;  
+        memcpy(result.GetData(), image.GetData(), 
+            image.GetWidth() * image.GetHeight() * 3);
     }
-    return val;
+    return result;
 }
@@ -13,6 +13,12 @@
 #include <string.h>
 #include <sstream>
 #include <stdlib.h>
+#include <atomic>
+#include <memory>
+#include "ocrAppEngine.h"
+#include "ocrAppPipeline.h"
+#include "ocrAppWriter.h"
+#include "ocrAppPool.h"
 
 using namespace std;
 
@@ -22,13 +28,38 @@ public:
     virtual bool OnInit();
 };
 
+//Progress of the Worker, Shown in the Status Bar
+wxDEFINE_EVENT(EVT_OCR_PROGRESS, wxThreadEvent);
+
+/*
+* Training and recognition run on a worker thread, one job after the
+* other, so the window never waits for them. The worker reports progress
+* with EVT_OCR_PROGRESS events and hands its results back with CallAfter.
+* Loading or clearing an image cancels the jobs in flight: every job
+* remembers the generation it was started in and is dropped once that
+* has changed.
+*
+* The loaded image is never changed. Its stages are kept by a pipeline
+* (see ocrAppPipeline.h) that only the worker uses, so identifying it
+* again with another matcher only scores the letters again.
+*/
 class MyFrame: public wxFrame
 {
 public:
     MyFrame(const wxString& title, const wxPoint& pos, 
         const wxSize& size);
+    ~MyFrame();
     
 private:
+    //A Recognition Running on the Worker
+    struct Reading
+    {
+        int generation;        //Generation the job was started in
+        shared_ptr<const OcrImage> binary;    //Binarized Image
+        shared_ptr<const OcrGlyphs> glyphs;   //Letters
+        shared_ptr<const PlateResult> result; //Reading of the Letters
+    };
+
     //GUI Functions
     void OnExit(wxCommandEvent& event);
     void OnAbout(wxCommandEvent& event);
@@ -48,28 +79,57 @@ private:
 
     //Recognition Functions
     void Identify(wxCommandEvent& event);
-    char identifier(wxImage &image);
-    char converter(int value);
+    void OnChamfer(wxCommandEvent& event);
+    void finish(const shared_ptr<Reading> &job);
+
+    //Background Functions
+    void progress(int job, const wxString &text);
+    void OnProgress(wxThreadEvent& event);
+    void cancel();
+
+    //Preview Functions
+    void show_input();
+    void show_binary();
+    void show_letter(int index);
+    
+    //Conversion Functions
+    static OcrImage to_ocr(const wxImage &image);
+    static wxImage to_wx(const OcrImage &image);
 
     //Definitions
     #define W 500
     #define H 500
 
     //Variables
-    wxImage input;       //Initial Image
-    wxImage theinputs[52];//Letters
-    wxImage trainset[52];//Training Set
+    wxImage input;       //Initial Image, Never Changed
+    string source;       //File of the Image
+    OcrEngine engine;    //Training Set and Plate Formats
+    OcrPipeline pipeline;//Stages of the Image, Used by the Worker Only
+    OcrWriter results;   //Saved Readings, Opened on the First Save
+    shared_ptr<const OcrImage> binary;    //Binarized Image
+    shared_ptr<const OcrGlyphs> letters;  //Letters
+    shared_ptr<const PlateResult> plate;  //Candidates and Scores of the Word
     string word;         //Interpretation
-    bool edited;         //Indicates whether an image has been edited
+    bool identified;     //Indicates whether the image has been identified
     bool loaded;         //Indicates whether an image has been loaded
+    bool busy;           //Indicates whether an Identify is in flight
+    bool again;          //Read again when it lands, the matcher changed
     int viewnow;
     int num_letters;
+    wxBitmap inputview;       //Input Scaled to the Panel, Made when Shown
+    wxBitmap binaryview;      //Same for the Binarized Image
+    wxBitmap letterviews[52]; //Letters Scaled to the Panel, Made when Shown
+    atomic<int> generation;   //Incremented to Cancel the Jobs in Flight
     
     //Declarations
 	wxStaticBitmap *WxStaticBitmap1;
     wxFileDialog* FileDialog1;
     wxStaticText *label;
 
+    //Threads, Last so They Stop before Anything Else is Destroyed
+    OcrPool pool;        //Threads of the Engine
+    OcrPool worker;      //Runs the Jobs One after the Other
+
     wxDECLARE_EVENT_TABLE();
 };
 
@@ -82,7 +142,8 @@ enum
     ID_WxBitmap1 = 6,
     ID_Next = 7,
     ID_Prev = 8,
-    ID_Img = 9
+    ID_Img = 9,
+    ID_Chamfer = 10
 };
 
 wxBEGIN_EVENT_TABLE(MyFrame, wxFrame)
@@ -96,6 +157,7 @@ wxBEGIN_EVENT_TABLE(MyFrame, wxFrame)
     EVT_MENU(ID_Next, MyFrame::viewnext)  
     EVT_MENU(ID_Prev, MyFrame::viewprev)  
     EVT_MENU(ID_Img, MyFrame::backtoimg)     
+    EVT_MENU(ID_Chamfer, MyFrame::OnChamfer)
 wxEND_EVENT_TABLE()
 
 wxIMPLEMENT_APP(MyApp);
@@ -110,7 +172,8 @@ bool MyApp::OnInit()
 
 MyFrame::MyFrame(const wxString& title, const wxPoint& pos, 
         const wxSize& size)
-        : wxFrame(NULL, wxID_ANY, title, pos, size)
+        : wxFrame(NULL, wxID_ANY, title, pos, size),
+          pipeline(engine), generation(0), worker(1)
 {
     wxInitAllImageHandlers();   //Initializes All Image Handlers
     
@@ -127,7 +190,9 @@ MyFrame::MyFrame(const wxString& title, const wxPoint& pos,
     menuExecute->Append(ID_Identify, "&Identify...\tCtrl-I",
                      "Identifies the character on screen");
     menuExecute->Append(ID_Save, "&Save Text...\tCtrl-S", 
-                     "Save Text to a .txt File");;
+                     "Append the Reading to results.jsonl");;
+    menuExecute->AppendCheckItem(ID_Chamfer, "Use &Chamfer Matching",
+                     "Matches letter edges instead of pixels");
     
     //Menu Bar - Help                 
     wxMenu *menuHelp = new wxMenu;
@@ -156,12 +221,18 @@ MyFrame::MyFrame(const wxString& title, const wxPoint& pos,
     wxFD_DEFAULT_STYLE, wxDefaultPosition, 
     wxDefaultSize, _T("wxFileDialog"));
     
-    //Initial Functions
-    train();
-    
     //Error Handling
     loaded = 0;
-    edited = 0;
+    identified = 0;
+    busy = 0;
+    again = 0;
+    num_letters = 0;
+    
+    //Initial Functions
+    //The engine is only used by the worker, so its jobs need no locking
+    Bind(EVT_OCR_PROGRESS, &MyFrame::OnProgress, this);
+    engine.set_pool(&pool);
+    worker.submit([this]{ train(); });
     
     //Text
     int w, h, h1, h2, h3, w1, w2;
@@ -173,7 +244,7 @@ MyFrame::MyFrame(const wxString& title, const wxPoint& pos,
         wxFONTWEIGHT_NORMAL));
     
     input.LoadFile("pattern.jpg", wxBITMAP_TYPE_ANY);
-    WxStaticBitmap1->SetBitmap(input.Scale(W,H));
+    show_input();
     
     label = new wxStaticText(this, wxID_ANY, "AlphabeticOCR", 
         wxPoint(0,h1), wxSize(w, h2), 
@@ -0,0 +1,278 @@
+/***************************************************************
+ * Name:      ocrAppMatch.cpp
+ * Purpose:   Code for Template Matching, Batched Bit-Packed Matching,
+ *            Top-K Candidate Selection and Confidence Scoring
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppMatch.h"
+#include <string.h>
+#include <atomic>
+
+using namespace std;
+
+//Functions
+bool cpu_supports(const char *name);
+
+const int glyph_sizes[NUM_GLYPH_SIZES] = { GLYPH_SMALL, GLYPH_MEDIUM, GLYPH_LARGE };
+
+/*
+* The glyph and the templates are thresholded images, so every pixel is
+* either 0 or 255 and all three channels are equal. Only the red channel
+* is compared, the same as reading GetRed(x,y) for every pixel, but the
+* buffers are walked directly instead of going through the accessors.
+*/
+void match_scores(const unsigned char *glyph,
+    const unsigned char *const templates[], int numTemplates,
+    int numPixels, int stat[])
+{
+    for (int i = 0; i < numTemplates; i++)
+    {
+        const unsigned char *temp = templates[i];
+        int count = 0;
+        for (int p = 0; p < numPixels * 3; p += 3)
+        {
+            if (glyph[p] == temp[p])
+                count++;
+        }
+        stat[i] = count;
+    }
+}
+
+/*
+* With the number of pixels known at compile time the word loop has a
+* fixed trip count and the inner loop always runs 64 times except for the
+* last word, so the compiler unrolls both. pack_bits picks the copy made
+* for the glyph size (or a pyramid level of the default one) and falls
+* back to a runtime count for other sizes.
+*/
+template<int PIXELS>
+static void pack_bits_fixed(const unsigned char *rgb, int pixels_rt,
+    uint64_t bits[])
+{
+    const int numPixels = (PIXELS > 0) ? PIXELS : pixels_rt;
+    const int words = WORDS_FOR(numPixels);
+    for (int w = 0; w < words; w++)
+    {
+        uint64_t word = 0;
+        int first = w * 64;
+        int last = (first + 64 < numPixels) ? first + 64 : numPixels;
+        //No branch per pixel, text and background are too mixed to predict
+        for (int p = first; p < last; p++)
+        {
+            word |= (uint64_t)(rgb[p * 3] == 0) << (p - first);
+        }
+        //Unused bits at the end stay 0 in glyphs and templates alike
+        bits[w] = word;
+    }
+}
+
+void pack_bits(const unsigned char *rgb, int numPixels, uint64_t bits[])
+{
+    switch (numPixels)
+    {
+    case GLYPH_SMALL * GLYPH_SMALL:
+        pack_bits_fixed<GLYPH_SMALL * GLYPH_SMALL>(rgb, numPixels, bits);
+        break;
+    case GLYPH_MEDIUM * GLYPH_MEDIUM:
+        pack_bits_fixed<GLYPH_MEDIUM * GLYPH_MEDIUM>(rgb, numPixels, bits);
+        break;
+    case GLYPH_LARGE * GLYPH_LARGE:
+        pack_bits_fixed<GLYPH_LARGE * GLYPH_LARGE>(rgb, numPixels, bits);
+        break;
+    case (GLYPH_LARGE/2) * (GLYPH_LARGE/2):
+        pack_bits_fixed<(GLYPH_LARGE/2) * (GLYPH_LARGE/2)>(rgb, numPixels,
+            bits);
+        break;
+    case (GLYPH_LARGE/4) * (GLYPH_LARGE/4):
+        pack_bits_fixed<(GLYPH_LARGE/4) * (GLYPH_LARGE/4)>(rgb, numPixels,
+            bits);
+        break;
+    default:
+        pack_bits_fixed<0>(rgb, numPixels, bits);
+        break;
+    }
+}
+
+/*
+* Nearest-neighbour in 16.16 fixed point like OcrImage::Rescale, but the
+* chosen pixels go straight into the bits, without a rescaled copy of
+* the glyph. For a level that halves the glyph this reads every other
+* pixel of every other row.
+*/
+void pack_bits_scaled(const unsigned char *rgb, int size, int newSize,
+    uint64_t bits[])
+{
+    unsigned long delta = ((unsigned long)size << 16) / newSize;
+    uint64_t word = 0;
+    int bit = 0;
+    int w = 0;
+
+    unsigned long y = 0;
+    for (int j = 0; j < newSize; j++)
+    {
+        const unsigned char *line = rgb + (y >> 16) * size * 3;
+        unsigned long x = 0;
+        for (int i = 0; i < newSize; i++)
+        {
+            word |= (uint64_t)(line[(x >> 16) * 3] == 0) << bit;
+            x += delta;
+            if (++bit == 64)
+            {
+                bits[w++] = word;
+                word = 0;
+                bit = 0;
+            }
+        }
+        y += delta;
+    }
+    //Unused bits at the end stay 0
+    if (bit > 0)
+        bits[w] = word;
+}
+
+/*
+* The batch kernel is in ocrAppMatchKernel.cpp. The CMake build compiles
+* it once per instruction set and the best one the CPU supports is picked
+* the first time it is needed. Other builds only have the generic one.
+*/
+struct BatchKernel
+{
+    const char *name;
+    void (*run)(const uint64_t[], int, const uint64_t[], int, int, int[]);
+};
+
+BatchKernel batch_kernels[] =
+{
+#ifdef OCR_KERNEL_DISPATCH
+    { "avx512", match_scores_batch_avx512 },
+    { "popcnt", match_scores_batch_popcnt },
+#endif
+    { "generic", match_scores_batch_generic },
+};
+const int num_batch_kernels = sizeof(batch_kernels) / sizeof(BatchKernel);
+//Atomic, as the first batches may come from several threads at once
+atomic<int> current_batch_kernel(-1);
+
+void match_scores_batch(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int numTemplates, int numPixels,
+    int stat[])
+{
+    if (current_batch_kernel < 0)
+    {
+        for (int k = 0; k < num_batch_kernels; k++)
+        {
+            if (use_batch_kernel(batch_kernels[k].name))
+                break;
+        }
+    }
+    BatchKernel &kernel = batch_kernels[current_batch_kernel.load()];
+    kernel.run(glyphs, numGlyphs, templates, numTemplates, numPixels, stat);
+}
+
+bool use_batch_kernel(const char *name)
+{
+    for (int k = 0; k < num_batch_kernels; k++)
+    {
+        if (strcmp(batch_kernels[k].name, name) != 0)
+            continue;
+        if (!cpu_supports(name))
+            return false;
+        current_batch_kernel = k;
+        return true;
+    }
+    return false;
+}
+
+const char *batch_kernel_name()
+{
+    if (current_batch_kernel < 0)
+        return "none";
+    return batch_kernels[current_batch_kernel.load()].name;
+}
+
+/*
+* Only the k best scores are ever needed, so instead of qsort-ing all of
+* stat[] the scores are inserted into a small array that is kept sorted.
+* This takes numTemplates*k steps at worst instead of a full sort.
+* On equal scores the later template wins, which is the same template the
+* old argmax loop picked. Templates that were left out of the matching
+* have a score of -1 and are never selected.
+*/
+int top_candidates(const int stat[], int numTemplates, int numPixels,
+    Candidate top[], int k)
+{
+    int count = 0;
+
+    for (int i = 0; i < numTemplates; i++)
+    {
+        //Skips unmatched templates and scores that cannot enter a full list
+        if (stat[i] < 0 || (count == k && stat[i] < top[k-1].score))
+            continue;
+
+        //Finds the slot and shifts the lower scores down
+        int pos = (count < k) ? count : k - 1;
+        while (pos > 0 && top[pos-1].score <= stat[i])
+        {
+            top[pos] = top[pos-1];
+            pos--;
+        }
+        top[pos].index = i;
+        top[pos].score = stat[i];
+        top[pos].norm = (numPixels > 0) ? (double)stat[i] / numPixels : 0;
+        if (count < k)
+            count++;
+    }
+    return count;
+}
+
+/*
+* The confidence is the part of the runner-up's mismatch that the winner
+* manages to close. Two templates with the same score give 0, while a
+* winner matching every pixel gives 1 regardless of the runner-up.
+*/
+double char_confidence(const Candidate top[], int count)
+{
+    if (count == 0)
+        return 0;
+    if (count == 1)
+        return 1;
+
+    double remaining = 1.0 - top[1].norm;
+    if (remaining <= 0)
+        return 0;
+    return (top[0].norm - top[1].norm) / remaining;
+}
+
+double plate_confidence(const CharResult results[], int num_letters)
+{
+    if (num_letters == 0)
+        return 0;
+
+    double lowest = 1;
+    for (int i = 0; i < num_letters; i++)
+    {
+        if (results[i].confidence < lowest)
+            lowest = results[i].confidence;
+    }
+    return lowest;
+}
+
+//Supplementary Code
+bool cpu_supports(const char *name)
+{
+    if (strcmp(name, "generic") == 0)
+        return true;
+#if defined(OCR_KERNEL_DISPATCH) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (strcmp(name, "popcnt") == 0)
+        return __builtin_cpu_supports("popcnt");
+    if (strcmp(name, "avx512") == 0)
+        return __builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+    return false;
+}
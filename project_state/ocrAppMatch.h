@@ -0,0 +1,97 @@
+/***************************************************************
+ * Name:      ocrAppMatch.h
+ * Purpose:   Defines Template Matching, Batched Bit-Packed Matching,
+ *            Top-K Candidate Selection and Confidence Scoring
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPMATCH_H
+#define OCRAPPMATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//Definitions
+#define NUM_TEMPLATES 52 //Number of images in the training set
+#define TOP_K 3          //Number of alternatives kept per character
+#define TILE_TEMPLATES 8 //Templates kept in L1 while all glyphs are scored
+#define WORDS_FOR(n) (((n) + 63) / 64) //64-bit words for n packed pixels
+
+//Glyph Sizes
+//Width and height of a normalized glyph. The matching and normalization
+//kernels are compiled for each of these; other sizes use the generic loops
+#define GLYPH_SMALL 32
+#define GLYPH_MEDIUM 64
+#define GLYPH_LARGE 100  //W/5 x H/5, the size of the original program
+#define NUM_GLYPH_SIZES 3
+extern const int glyph_sizes[NUM_GLYPH_SIZES];
+
+//Glyph Pyramid
+//Every glyph and template is also kept at half and a quarter of the
+//glyph size (100/50/25); these levels have their own kernels too
+#define PYRAMID_LEVELS 3
+#define PYRAMID_SIZE(size, level) ((size) >> (level))
+
+//A single alternative for a character
+struct Candidate
+{
+    int index;      //Index of the template (see MyFrame::converter)
+    int score;      //Number of pixels equal to the template
+    double norm;    //Score divided by the number of pixels (0 to 1)
+};
+
+//Result of matching one character against the training set
+struct CharResult
+{
+    Candidate top[TOP_K]; //Best candidates, highest score first
+    int count;            //Number of valid entries in top
+    double confidence;    //0 for a coin flip, 1 for a clear winner
+    int level;            //Pyramid level the scores were taken at
+};
+
+//Matching Functions
+//Counts the equal pixels of a glyph and each template. The buffers
+//are RGB data (as returned by wxImage::GetData) of numPixels pixels
+void match_scores(const unsigned char *glyph,
+    const unsigned char *const templates[], int numTemplates,
+    int numPixels, int stat[]);
+//Packs a thresholded RGB buffer to one bit per pixel, 1 for black
+//(specialized for the pixels of the glyph sizes)
+void pack_bits(const unsigned char *rgb, int numPixels, uint64_t bits[]);
+//Packs a size x size RGB glyph rescaled to newSize x newSize, with the
+//same pixels as rescale_glyph would give, for the pyramid levels
+void pack_bits_scaled(const unsigned char *rgb, int size, int newSize,
+    uint64_t bits[]);
+//Scores numGlyphs packed glyphs against numTemplates packed templates
+//at once, stat[g*numTemplates + t] is the same as match_scores gives.
+//The kernels are specialized for NUM_TEMPLATES templates of a glyph size
+void match_scores_batch(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int numTemplates, int numPixels,
+    int stat[]);
+//Picks the batch kernel ("avx512", "popcnt" or "generic"), returns
+//false if it was not built or the CPU cannot run it
+bool use_batch_kernel(const char *name);
+const char *batch_kernel_name();
+//Kernels behind match_scores_batch (see ocrAppMatchKernel.cpp)
+void match_scores_batch_generic(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int numTemplates, int numPixels,
+    int stat[]);
+void match_scores_batch_popcnt(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int numTemplates, int numPixels,
+    int stat[]);
+void match_scores_batch_avx512(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int numTemplates, int numPixels,
+    int stat[]);
+//Keeps the k highest scores without sorting the whole histogram
+int top_candidates(const int stat[], int numTemplates, int numPixels,
+    Candidate top[], int k);
+
+//Confidence Functions
+//Confidence of a single character from its best two candidates
+double char_confidence(const Candidate top[], int count);
+//Confidence of a plate, limited by its least certain character
+double plate_confidence(const CharResult results[], int num_letters);
+
+#endif
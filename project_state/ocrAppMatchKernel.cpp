@@ -0,0 +1,161 @@
+/***************************************************************
+ * Name:      ocrAppMatchKernel.cpp
+ * Purpose:   Code for the Batched Bit-Packed Matching Kernel
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppMatch.h"
+
+/*
+* This file is compiled once per instruction set by the CMake build, with
+* OCR_KERNEL_SUFFIX set to the name of the set and the matching -m flags,
+* so every copy of the kernel gets its own name and its own code. The
+* dispatcher in ocrAppMatch.cpp picks one at runtime.
+*/
+#ifndef OCR_KERNEL_SUFFIX
+#define OCR_KERNEL_SUFFIX generic
+#endif
+#define KERNEL_JOIN(name, suffix) name##_##suffix
+#define KERNEL_EXPAND(name, suffix) KERNEL_JOIN(name, suffix)
+#define KERNEL_NAME(name) KERNEL_EXPAND(name, OCR_KERNEL_SUFFIX)
+
+//Inlined so that it compiles to the popcount of this instruction set
+static inline int kernel_popcount(uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/*
+* Batched Matching
+* With one bit per pixel, the pixels that differ between a glyph and a
+* template are the set bits of their XOR, so the score is numPixels minus
+* a popcount, 64 pixels at a time.
+* The templates are taken TILE_TEMPLATES at a time (about 10 KB at
+* 100x100) and every glyph is scored against the tile before moving on,
+* so the tile stays in L1 while the glyphs stream past it. Four templates
+* share each glyph word that is loaded. For a word or a batch of plates
+* the template set is read from memory once instead of once per glyph.
+*
+* WORDS and TEMPLATES are the words per glyph and the number of templates
+* when they are known at compile time, or 0 to take them at runtime. With
+* both known every trip count is a constant: the tile loop is fully
+* unrolled and the word loop is unrolled and vectorized for the glyph size.
+*/
+template<int WORDS, int TEMPLATES>
+static void batch_kernel(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int templates_rt, int numPixels,
+    int stat[])
+{
+    const int words = (WORDS > 0) ? WORDS : WORDS_FOR(numPixels);
+    const int numTemplates = (TEMPLATES > 0) ? TEMPLATES : templates_rt;
+
+    for (int tile = 0; tile < numTemplates; tile += TILE_TEMPLATES)
+    {
+        int tileEnd = tile + TILE_TEMPLATES;
+        if (tileEnd > numTemplates)
+            tileEnd = numTemplates;
+
+        for (int g = 0; g < numGlyphs; g++)
+        {
+            const uint64_t *glyph = glyphs + (size_t)g * words;
+            int *row = stat + (size_t)g * numTemplates;
+            int t = tile;
+
+            //Four Templates per Glyph Word
+            for (; t + 4 <= tileEnd; t += 4)
+            {
+                const uint64_t *t0 = templates + (size_t)t * words;
+                const uint64_t *t1 = t0 + words;
+                const uint64_t *t2 = t1 + words;
+                const uint64_t *t3 = t2 + words;
+                int d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+                for (int w = 0; w < words; w++)
+                {
+                    uint64_t word = glyph[w];
+                    d0 += kernel_popcount(word ^ t0[w]);
+                    d1 += kernel_popcount(word ^ t1[w]);
+                    d2 += kernel_popcount(word ^ t2[w]);
+                    d3 += kernel_popcount(word ^ t3[w]);
+                }
+                row[t] = numPixels - d0;
+                row[t+1] = numPixels - d1;
+                row[t+2] = numPixels - d2;
+                row[t+3] = numPixels - d3;
+            }
+
+            //Remaining Templates of the Tile
+            for (; t < tileEnd; t++)
+            {
+                const uint64_t *temp = templates + (size_t)t * words;
+                int d = 0;
+                for (int w = 0; w < words; w++)
+                {
+                    d += kernel_popcount(glyph[w] ^ temp[w]);
+                }
+                row[t] = numPixels - d;
+            }
+        }
+    }
+}
+
+//Glyph Size Dispatch
+#define FIXED_WORDS(size) WORDS_FOR((size) * (size))
+
+/*
+* The bank has NUM_TEMPLATES samples until the first one is learned or
+* removed, and any number after that, so the glyph size is specialized
+* whatever the count; only the tile loop then runs to a runtime bound.
+*/
+template<int WORDS>
+static void sized_kernel(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int numTemplates, int numPixels,
+    int stat[])
+{
+    if (numTemplates == NUM_TEMPLATES)
+        batch_kernel<WORDS, NUM_TEMPLATES>(glyphs, numGlyphs, templates,
+            numTemplates, numPixels, stat);
+    else
+        batch_kernel<WORDS, 0>(glyphs, numGlyphs, templates,
+            numTemplates, numPixels, stat);
+}
+
+void KERNEL_NAME(match_scores_batch)(const uint64_t glyphs[], int numGlyphs,
+    const uint64_t templates[], int numTemplates, int numPixels,
+    int stat[])
+{
+    switch (numPixels)
+    {
+    case GLYPH_SMALL * GLYPH_SMALL:
+        sized_kernel<FIXED_WORDS(GLYPH_SMALL)>(glyphs, numGlyphs,
+            templates, numTemplates, numPixels, stat);
+        return;
+    case GLYPH_MEDIUM * GLYPH_MEDIUM:
+        sized_kernel<FIXED_WORDS(GLYPH_MEDIUM)>(glyphs, numGlyphs,
+            templates, numTemplates, numPixels, stat);
+        return;
+    case GLYPH_LARGE * GLYPH_LARGE:
+        sized_kernel<FIXED_WORDS(GLYPH_LARGE)>(glyphs, numGlyphs,
+            templates, numTemplates, numPixels, stat);
+        return;
+    //Pyramid Levels of GLYPH_LARGE
+    case (GLYPH_LARGE/2) * (GLYPH_LARGE/2):
+        sized_kernel<FIXED_WORDS(GLYPH_LARGE/2)>(glyphs, numGlyphs,
+            templates, numTemplates, numPixels, stat);
+        return;
+    case (GLYPH_LARGE/4) * (GLYPH_LARGE/4):
+        sized_kernel<FIXED_WORDS(GLYPH_LARGE/4)>(glyphs, numGlyphs,
+            templates, numTemplates, numPixels, stat);
+        return;
+    }
+    batch_kernel<0, 0>(glyphs, numGlyphs, templates, numTemplates,
+        numPixels, stat);
+}
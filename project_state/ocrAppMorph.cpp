@@ -0,0 +1,381 @@
+/***************************************************************
+ * Name:      ocrAppMorph.cpp
+ * Purpose:   Code for the Morphological Cleanup of Binary Plates on
+ *            Bitmaps with One Bit per Pixel
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppMorph.h"
+#include <algorithm>
+
+using namespace std;
+
+//A Horizontal Run of Black and the Component it Belongs to
+struct MorphRun
+{
+    int y, start, end;      //Pixels start to end - 1 of row y
+    int parent;             //Union-find link, itself for a root
+};
+
+//Bounds and Size of a Component
+struct MorphComponent
+{
+    int x0, y0, x1, y1;
+    long area;
+    bool removed;
+};
+
+//Functions
+uint64_t last_mask(int width);
+void row_step(const uint64_t *in, uint64_t *out, int stride, uint64_t mask,
+    bool erosion);
+void morph(OcrBitmap &bitmap, int radiusX, int radiusY, bool erosion);
+void find_runs(const OcrBitmap &bitmap, vector<MorphRun> &runs);
+int find_root(vector<MorphRun> &runs, int run);
+int find_bit(const uint64_t *row, int stride, int width, int from,
+    bool black);
+
+//Definitions
+#define MAX_FRAME_TEST 1024 //More components than this are not searched
+                            //for frames (that is a page of noise)
+
+//Bitmap Functions
+void pack_bitmap(const OcrImage &binary, OcrBitmap &bitmap)
+{
+    bitmap.width = binary.GetWidth();
+    bitmap.height = binary.GetHeight();
+    bitmap.stride = (bitmap.width + 63) / 64;
+    bitmap.bits.assign((size_t)bitmap.stride * bitmap.height, 0);
+
+    const unsigned char *data = binary.GetData();
+    for (int y = 0; y < bitmap.height; y++)
+    {
+        const unsigned char *pixel = data + (size_t)y * bitmap.width * 3;
+        uint64_t *row = &bitmap.bits[(size_t)y * bitmap.stride];
+        for (int w = 0; w < bitmap.stride; w++)
+        {
+            int count = bitmap.width - w * 64;
+            count = (count < 64) ? count : 64;
+            uint64_t word = 0;
+            for (int b = 0; b < count; b++, pixel += 3)
+                word |= (uint64_t)(pixel[0] == 0) << b;
+            row[w] = word;
+        }
+    }
+}
+
+void unpack_bitmap(const OcrBitmap &bitmap, OcrImage &binary)
+{
+    if (binary.GetWidth() != bitmap.width ||
+        binary.GetHeight() != bitmap.height)
+        binary.Create(bitmap.width, bitmap.height);
+    unsigned char *pixel = binary.GetData();
+    for (int y = 0; y < bitmap.height; y++)
+    {
+        const uint64_t *row = &bitmap.bits[(size_t)y * bitmap.stride];
+        for (int x = 0; x < bitmap.width; x++, pixel += 3)
+        {
+            int lum = (row[x >> 6] >> (x & 63) & 1) ? 0 : 255;
+            pixel[0] = pixel[1] = pixel[2] = lum;
+        }
+    }
+}
+
+/*
+* Morphology
+* A step of a 3 pixel wide box along a row is two shifts of the row: for
+* every bit, the word shifted left by one holds its left neighbour and
+* the word shifted right its right neighbour, with the bit crossing from
+* the next word brought in. Erosion ANDs the three, dilation ORs them,
+* 64 pixels per operation. Down the columns, the rows above and below
+* are combined the same way whole words at a time. A larger box is the
+* same step repeated, as boxes add up.
+*/
+void erode(OcrBitmap &bitmap, int radiusX, int radiusY)
+{
+    morph(bitmap, radiusX, radiusY, true);
+}
+
+void dilate(OcrBitmap &bitmap, int radiusX, int radiusY)
+{
+    morph(bitmap, radiusX, radiusY, false);
+}
+
+void open_bitmap(OcrBitmap &bitmap, int radiusX, int radiusY)
+{
+    erode(bitmap, radiusX, radiusY);
+    dilate(bitmap, radiusX, radiusY);
+}
+
+void close_bitmap(OcrBitmap &bitmap, int radiusX, int radiusY)
+{
+    dilate(bitmap, radiusX, radiusY);
+    erode(bitmap, radiusX, radiusY);
+}
+
+void morph(OcrBitmap &bitmap, int radiusX, int radiusY, bool erosion)
+{
+    int stride = bitmap.stride;
+    int height = bitmap.height;
+    if (stride == 0 || height == 0)
+        return;
+    uint64_t mask = last_mask(bitmap.width);
+    uint64_t pad = erosion ? ~0ULL : 0;
+    vector<uint64_t> other(bitmap.bits.size());
+
+    //Along the Rows
+    for (int r = 0; r < radiusX; r++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            row_step(&bitmap.bits[(size_t)y * stride],
+                &other[(size_t)y * stride], stride, mask, erosion);
+        }
+        bitmap.bits.swap(other);
+    }
+
+    //Down the Columns
+    for (int r = 0; r < radiusY; r++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            const uint64_t *above = (y > 0) ?
+                &bitmap.bits[(size_t)(y - 1) * stride] : NULL;
+            const uint64_t *row = &bitmap.bits[(size_t)y * stride];
+            const uint64_t *below = (y + 1 < height) ?
+                &bitmap.bits[(size_t)(y + 1) * stride] : NULL;
+            uint64_t *out = &other[(size_t)y * stride];
+            for (int w = 0; w < stride; w++)
+            {
+                uint64_t up = above ? above[w] : pad;
+                uint64_t down = below ? below[w] : pad;
+                out[w] = erosion ? (up & row[w] & down) :
+                    (up | row[w] | down);
+            }
+            out[stride - 1] &= mask;
+        }
+        bitmap.bits.swap(other);
+    }
+}
+
+/*
+* Components
+* The runs of black of every row are found a word at a time, by counting
+* the trailing zeros of the word (or of its complement). A run joins the
+* runs of the row above that touch it, diagonals included, in a
+* union-find over the runs, so every pixel is read only once.
+*/
+int remove_components(OcrBitmap &bitmap, int minArea, double ratio,
+    bool frames)
+{
+    vector<MorphRun> runs;
+    find_runs(bitmap, runs);
+    if (runs.empty())
+        return 0;
+
+    //Bounds and Areas per Root
+    vector<int> index(runs.size(), -1);
+    vector<MorphComponent> components;
+    long largest = 0;
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        int root = find_root(runs, i);
+        if (index[root] < 0)
+        {
+            MorphComponent component = { runs[i].start, runs[i].y,
+                runs[i].end - 1, runs[i].y, 0, false };
+            index[root] = components.size();
+            components.push_back(component);
+        }
+        MorphComponent &c = components[index[root]];
+        c.x0 = min(c.x0, runs[i].start);
+        c.x1 = max(c.x1, runs[i].end - 1);
+        c.y0 = min(c.y0, runs[i].y);
+        c.y1 = max(c.y1, runs[i].y);
+        c.area += runs[i].end - runs[i].start;
+        largest = max(largest, c.area);
+    }
+
+    //Specks
+    long smallest = max((long)minArea, (long)(largest * ratio));
+    vector<int> kept;
+    for (size_t c = 0; c < components.size(); c++)
+    {
+        components[c].removed = components[c].area < smallest;
+        if (!components[c].removed)
+            kept.push_back(c);
+    }
+
+    //Frames, Found by what they Enclose
+    if (frames && kept.size() <= MAX_FRAME_TEST)
+    {
+        vector<bool> frame(kept.size(), false);
+        for (size_t a = 0; a < kept.size(); a++)
+        {
+            const MorphComponent &outer = components[kept[a]];
+            int enclosed = 0;
+            for (size_t b = 0; b < kept.size() && enclosed < 2; b++)
+            {
+                const MorphComponent &inner = components[kept[b]];
+                if (a != b && inner.x0 > outer.x0 && inner.x1 < outer.x1 &&
+                    inner.y0 > outer.y0 && inner.y1 < outer.y1)
+                    enclosed++;
+            }
+            frame[a] = enclosed >= 2;
+        }
+        for (size_t a = 0; a < kept.size(); a++)
+        {
+            if (frame[a])
+                components[kept[a]].removed = true;
+        }
+    }
+
+    //Clearing of the Runs
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        if (!components[index[find_root(runs, i)]].removed)
+            continue;
+        uint64_t *row = &bitmap.bits[(size_t)runs[i].y * bitmap.stride];
+        for (int x = runs[i].start; x < runs[i].end; x++)
+            row[x >> 6] &= ~(1ULL << (x & 63));
+    }
+    int removed = 0;
+    for (size_t c = 0; c < components.size(); c++)
+        removed += components[c].removed;
+    return removed;
+}
+
+int stroke_width(const OcrBitmap &bitmap)
+{
+    vector<MorphRun> runs;
+    find_runs(bitmap, runs);
+    if (runs.empty())
+        return 0;
+    vector<int> lengths(runs.size());
+    for (size_t i = 0; i < runs.size(); i++)
+        lengths[i] = runs[i].end - runs[i].start;
+    nth_element(lengths.begin(), lengths.begin() + lengths.size() / 2,
+        lengths.end());
+    return lengths[lengths.size() / 2];
+}
+
+/*
+* Only cracks across the strokes are closed, with a box one pixel wide:
+* a wider one would also bridge letters set a pixel or two apart, and
+* segmentation_word needs an empty column between them. Opening removes
+* anything thinner than 3 pixels, so it is left out for plates whose
+* strokes are not clearly wider than that.
+*/
+int clean_binary(OcrImage &binary)
+{
+    if (!binary.IsOk())
+        return 0;
+    OcrBitmap bitmap;
+    pack_bitmap(binary, bitmap);
+    close_bitmap(bitmap, 0, 1);
+    if (stroke_width(bitmap) >= THICK_STROKE)
+        open_bitmap(bitmap, 1, 1);
+    int removed = remove_components(bitmap, SPECK_AREA, SPECK_RATIO, true);
+    unpack_bitmap(bitmap, binary);
+    return removed;
+}
+
+//Supplementary Code
+//The bits of the last word of a row that are inside the bitmap
+uint64_t last_mask(int width)
+{
+    return (width % 64 == 0) ? ~0ULL : (1ULL << (width % 64)) - 1;
+}
+
+//One step of a 3 pixel box along a row, for erosion or dilation
+void row_step(const uint64_t *in, uint64_t *out, int stride, uint64_t mask,
+    bool erosion)
+{
+    uint64_t pad = erosion ? ~0ULL : 0;
+    for (int w = 0; w < stride; w++)
+    {
+        //Past the Width is Outside
+        uint64_t word = in[w];
+        uint64_t prev = (w > 0) ? in[w - 1] : pad;
+        uint64_t next = (w + 1 < stride) ? in[w + 1] : pad;
+        if (w == stride - 1)
+            word = (word & mask) | (pad & ~mask);
+        else if (w + 1 == stride - 1)
+            next = (next & mask) | (pad & ~mask);
+
+        uint64_t left = (word << 1) | (prev >> 63);
+        uint64_t right = (word >> 1) | (next << 63);
+        out[w] = erosion ? (word & left & right) : (word | left | right);
+    }
+    out[stride - 1] &= mask;
+}
+
+void find_runs(const OcrBitmap &bitmap, vector<MorphRun> &runs)
+{
+    int above = 0;      //First run of the row above
+    for (int y = 0; y < bitmap.height; y++)
+    {
+        const uint64_t *row = &bitmap.bits[(size_t)y * bitmap.stride];
+        int first = runs.size();
+        int x = find_bit(row, bitmap.stride, bitmap.width, 0, true);
+        while (x < bitmap.width)
+        {
+            int end = find_bit(row, bitmap.stride, bitmap.width, x, false);
+            MorphRun run = { y, x, end, (int)runs.size() };
+            runs.push_back(run);
+            x = find_bit(row, bitmap.stride, bitmap.width, end, true);
+        }
+
+        //Runs of the Row Above that Touch, Diagonals Included
+        int p = above;
+        for (int r = first; r < (int)runs.size(); r++)
+        {
+            while (p < first && runs[p].end < runs[r].start)
+                p++;
+            for (int q = p; q < first && runs[q].start <= runs[r].end; q++)
+            {
+                int a = find_root(runs, q), b = find_root(runs, r);
+                if (a != b)
+                    runs[max(a, b)].parent = min(a, b);
+            }
+        }
+        above = first;
+    }
+}
+
+int find_root(vector<MorphRun> &runs, int run)
+{
+    while (runs[run].parent != run)
+    {
+        runs[run].parent = runs[runs[run].parent].parent;
+        run = runs[run].parent;
+    }
+    return run;
+}
+
+//First pixel from from on that is black (or white), or the width
+int find_bit(const uint64_t *row, int stride, int width, int from,
+    bool black)
+{
+    int w = from >> 6;
+    if (w >= stride)
+        return width;
+    uint64_t word = (black ? row[w] : ~row[w]) & (~0ULL << (from & 63));
+    while (word == 0)
+    {
+        if (++w == stride)
+            return width;
+        word = black ? row[w] : ~row[w];
+    }
+#if defined(__GNUC__)
+    int x = w * 64 + __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word >> bit & 1))
+        bit++;
+    int x = w * 64 + bit;
+#endif
+    return (x < width) ? x : width;
+}
@@ -0,0 +1,66 @@
+/***************************************************************
+ * Name:      ocrAppMorph.h
+ * Purpose:   Defines the Morphological Cleanup of Binary Plates on
+ *            Bitmaps with One Bit per Pixel
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPMORPH_H
+#define OCRAPPMORPH_H
+
+#include <stdint.h>
+#include <vector>
+#include "ocrImage.h"
+
+using namespace std;
+
+//Definitions
+#define SPECK_AREA 6        //Components of fewer pixels are always noise
+#define SPECK_RATIO 0.02    //Or smaller than this part of the largest one
+#define THICK_STROKE 4      //Strokes at least this wide survive an opening
+
+/*
+* A binary image with one bit per pixel, 1 for black, as pack_bits has
+* them. Every row starts on a new word, pixel x of a row is bit x % 64 of
+* its word x / 64, and the bits past the width are always 0.
+*/
+struct OcrBitmap
+{
+    int width;
+    int height;
+    int stride;             //Words per row
+    vector<uint64_t> bits;
+};
+
+//Bitmap Functions
+void pack_bitmap(const OcrImage &binary, OcrBitmap &bitmap);
+void unpack_bitmap(const OcrBitmap &bitmap, OcrImage &binary);
+
+//Morphology Functions
+//With a rectangle of (2 radiusX + 1) x (2 radiusY + 1) pixels, 64 pixels
+//at a time. Pixels outside the bitmap count as white for dilation and
+//as black for erosion, so text touching the edge is not eaten away
+void erode(OcrBitmap &bitmap, int radiusX, int radiusY);
+void dilate(OcrBitmap &bitmap, int radiusX, int radiusY);
+//Erosion then dilation, removes specks and lines thinner than the box
+void open_bitmap(OcrBitmap &bitmap, int radiusX, int radiusY);
+//Dilation then erosion, fills pinholes and cracks narrower than the box
+void close_bitmap(OcrBitmap &bitmap, int radiusX, int radiusY);
+
+//Component Functions
+//Clears the 8-connected components of fewer than minArea pixels or of
+//less than ratio times the largest one and, with frames, those that
+//enclose at least two others (plate borders). Returns how many it clears
+int remove_components(OcrBitmap &bitmap, int minArea, double ratio,
+    bool frames);
+//Median length of the horizontal runs of black, about the stroke width
+int stroke_width(const OcrBitmap &bitmap);
+
+//Cleans a thresholded plate before it is cropped: closes vertical
+//cracks, opens it when its strokes are thick enough to survive that,
+//then removes specks and frames. Returns the components removed
+int clean_binary(OcrImage &binary);
+
+#endif
@@ -0,0 +1,133 @@
+/***************************************************************
+ * Name:      ocrAppPipeline.cpp
+ * Purpose:   Code for the Memoized Stages of a Recognition
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppPipeline.h"
+
+using namespace std;
+
+OcrPipeline::OcrPipeline(const OcrEngine &engine)
+    : engine(engine), sourceStage(), grayStage(), binaryStage(),
+      plateStage(), glyphStage(), resultStage()
+{
+    versions = 0;
+    made = 0;
+}
+
+void OcrPipeline::set_source(const OcrImage &image)
+{
+    //Every later stage sees a new input version and is made again
+    sourceStage.value.reset(new OcrImage(image));
+    sourceStage.version = ++versions;
+}
+
+bool OcrPipeline::has_source() const
+{
+    return sourceStage.value != NULL;
+}
+
+int OcrPipeline::runs() const
+{
+    return made;
+}
+
+//Stages
+shared_ptr<const OcrImage> OcrPipeline::source() const
+{
+    return sourceStage.value;
+}
+
+shared_ptr<const OcrImage> OcrPipeline::gray()
+{
+    return filter(grayStage, sourceStage, &OcrEngine::to_gray, 0);
+}
+
+shared_ptr<const OcrImage> OcrPipeline::binary()
+{
+    gray();
+    return filter(binaryStage, grayStage, &OcrEngine::to_binary, 0);
+}
+
+shared_ptr<const OcrImage> OcrPipeline::plate()
+{
+    binary();
+    return filter(plateStage, binaryStage, &OcrEngine::crop_plate,
+        engine.plate_revision());
+}
+
+shared_ptr<const OcrGlyphs> OcrPipeline::glyphs()
+{
+    shared_ptr<const OcrImage> from = plate();
+    if (from == NULL)
+        return shared_ptr<const OcrGlyphs>();
+    if (fresh(glyphStage, plateStage.version, engine.glyph_size()))
+        return glyphStage.value;
+
+    //The Letters are Read from the Kept Plate, which is not Copied
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    OcrGlyphs *glyphs = new OcrGlyphs;
+    glyphs->num_letters = engine.split_letters(*from, glyphs->letters);
+    keep(glyphStage, glyphs, plateStage.version, engine.glyph_size(),
+        start);
+    return glyphStage.value;
+}
+
+shared_ptr<const PlateResult> OcrPipeline::result()
+{
+    shared_ptr<const OcrGlyphs> from = glyphs();
+    if (from == NULL)
+        return shared_ptr<const PlateResult>();
+    if (fresh(resultStage, glyphStage.version, engine.revision()))
+        return resultStage.value;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    PlateResult *result = new PlateResult;
+    engine.identify(from->letters, from->num_letters, *result);
+    result->timings[STAGE_GRAY] = grayStage.micros;
+    result->timings[STAGE_BINARY] = binaryStage.micros;
+    result->timings[STAGE_PLATE] = plateStage.micros;
+    result->timings[STAGE_LETTERS] = glyphStage.micros;
+    keep(resultStage, result, glyphStage.version, engine.revision(), start);
+    return resultStage.value;
+}
+
+//Pipeline Functions
+template<class T> bool OcrPipeline::fresh(const OcrStage<T> &stage,
+    long input, long setting) const
+{
+    return stage.value != NULL && stage.input == input &&
+        stage.setting == setting;
+}
+
+template<class T> void OcrPipeline::keep(OcrStage<T> &stage, T *value,
+    long input, long setting, chrono::steady_clock::time_point start)
+{
+    stage.micros = chrono::duration<double, micro>(
+        chrono::steady_clock::now() - start).count();
+    stage.value.reset(value);
+    stage.version = ++versions;
+    stage.input = input;
+    stage.setting = setting;
+    made++;
+}
+
+//A stage that is one engine step on a copy of the stage before it
+shared_ptr<const OcrImage> OcrPipeline::filter(OcrStage<OcrImage> &stage,
+    const OcrStage<OcrImage> &from,
+    void (OcrEngine::*step)(OcrImage &) const, long setting)
+{
+    if (from.value == NULL)
+        return shared_ptr<const OcrImage>();
+    if (fresh(stage, from.version, setting))
+        return stage.value;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    OcrImage *image = new OcrImage(from.value->Copy());
+    (engine.*step)(*image);
+    keep(stage, image, from.version, setting, start);
+    return stage.value;
+}
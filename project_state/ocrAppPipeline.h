@@ -0,0 +1,94 @@
+/***************************************************************
+ * Name:      ocrAppPipeline.h
+ * Purpose:   Defines the Memoized Stages of a Recognition
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPPIPELINE_H
+#define OCRAPPPIPELINE_H
+
+#include <memory>
+#include <chrono>
+#include "ocrAppEngine.h"
+
+using namespace std;
+
+//Letters of a plate, as cut by the engine
+struct OcrGlyphs
+{
+    int num_letters;
+    OcrImage letters[MAX_LETTERS];
+};
+
+//A Stage and what it was Made From
+template<class T> struct OcrStage
+{
+    shared_ptr<const T> value;  //NULL until made
+    long version;               //Changes whenever the value is made again
+    long input;                 //Version of the stage it was made from
+    long setting;               //Setting of the engine it was made with
+    double micros;              //Time it took to make
+};
+
+/*
+* The recognition of one image as a graph of stages:
+*
+*   source -> gray -> binary -> plate -> glyphs -> result
+*
+* Every stage is made from a copy of the stage before it, so the source
+* and every image in between stay as they were. A stage is only made when
+* asked for, and is kept until the stage it comes from or the setting it
+* depends on changes: a new matcher or pyramid only scores the letters
+* again, a new glyph size cuts them again, a new deskew limit or cleanup
+* crops the plate again, and only a new source redoes the filters. The
+* timings of the result are those of the stages it was made from,
+* whenever they were made.
+*
+* A pipeline is meant for one thread at a time. The values it returns
+* are never changed afterwards and may be handed to other threads.
+*/
+class OcrPipeline
+{
+public:
+    OcrPipeline(const OcrEngine &engine);
+
+    //A new source, every stage will be made again
+    void set_source(const OcrImage &image);
+    bool has_source() const;
+
+    //Stages
+    shared_ptr<const OcrImage> source() const;
+    shared_ptr<const OcrImage> gray();
+    shared_ptr<const OcrImage> binary();
+    shared_ptr<const OcrImage> plate();
+    shared_ptr<const OcrGlyphs> glyphs();
+    shared_ptr<const PlateResult> result();
+
+    //Number of stages made so far
+    int runs() const;
+
+private:
+    //Pipeline Functions
+    template<class T> bool fresh(const OcrStage<T> &stage, long input,
+        long setting) const;
+    template<class T> void keep(OcrStage<T> &stage, T *value, long input,
+        long setting, chrono::steady_clock::time_point start);
+    shared_ptr<const OcrImage> filter(OcrStage<OcrImage> &stage,
+        const OcrStage<OcrImage> &from,
+        void (OcrEngine::*step)(OcrImage &) const, long setting);
+
+    //Variables
+    const OcrEngine &engine;
+    OcrStage<OcrImage> sourceStage;
+    OcrStage<OcrImage> grayStage;
+    OcrStage<OcrImage> binaryStage;
+    OcrStage<OcrImage> plateStage;
+    OcrStage<OcrGlyphs> glyphStage;
+    OcrStage<PlateResult> resultStage;
+    long versions;  //Last version given to a stage
+    int made;       //Stages made so far
+};
+
+#endif
@@ -0,0 +1,400 @@
+/***************************************************************
+ * Name:      ocrAppPool.cpp
+ * Purpose:   Code for the Work-Stealing Thread Pool shared by the
+ *            Engine, the Command Line Tools and the Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppPool.h"
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+//Functions
+vector<int> allowed_cpus();
+vector< vector<int> > numa_nodes(const vector<int> &allowed);
+
+//Worker Running the Current Thread
+static thread_local const OcrPool *current_pool = NULL;
+static thread_local int current_index = -1;
+
+/*
+* The range of a parallel_for. It is shared with the helper tasks, which
+* may only get to run after the loop is over; they then find no chunk
+* left and return without touching the body.
+*/
+struct ParallelRange
+{
+    int begin, end, grain, chunks;
+    const function<void(int, int)> *body;
+    atomic<int> next;   //Next chunk to hand out
+    atomic<int> done;   //Chunks finished
+    mutex lock;
+    condition_variable finished;
+};
+
+void run_chunks(ParallelRange &range)
+{
+    int chunk;
+    while ((chunk = range.next++) < range.chunks)
+    {
+        int first = range.begin + chunk * range.grain;
+        int last = first + range.grain;
+        if (last > range.end)
+            last = range.end;
+        (*range.body)(first, last);
+
+        if (++range.done == range.chunks)
+        {
+            lock_guard<mutex> guard(range.lock);
+            range.finished.notify_all();
+        }
+    }
+}
+
+OcrPool::OcrPool(int threads, int placement)
+    : queued(0), stopping(false)
+{
+    if (threads <= 0)
+        threads = thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.push_back(new Worker);
+        workers[i]->node = 0;
+    }
+    place(placement);
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i]->handle = thread(&OcrPool::run, this, i);
+    }
+}
+
+OcrPool::~OcrPool()
+{
+    {
+        lock_guard<mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    //Workers still look into each other's deques until they all stop
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->handle.join();
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        delete workers[i];
+    }
+}
+
+int OcrPool::size() const
+{
+    return workers.size();
+}
+
+int OcrPool::node_of(int worker) const
+{
+    return workers[worker]->node;
+}
+
+int OcrPool::current_worker()
+{
+    return current_index;
+}
+
+//Pool Functions
+void OcrPool::submit(const function<void()> &task)
+{
+    push(task);
+}
+
+void OcrPool::parallel_for(int begin, int end, int grain,
+    const function<void(int, int)> &body)
+{
+    int count = end - begin;
+    if (count <= 0)
+        return;
+    //Four chunks per thread leave room to even out uneven chunks
+    if (grain <= 0)
+        grain = (count + 4 * (size() + 1) - 1) / (4 * (size() + 1));
+    int chunks = (count + grain - 1) / grain;
+    if (chunks == 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    shared_ptr<ParallelRange> range(new ParallelRange);
+    range->begin = begin;
+    range->end = end;
+    range->grain = grain;
+    range->chunks = chunks;
+    range->body = &body;
+    range->next = 0;
+    range->done = 0;
+
+    //One Helper per Worker that could Join, the Caller Works Too
+    int helpers = (chunks - 1 < size()) ? chunks - 1 : size();
+    for (int i = 0; i < helpers; i++)
+    {
+        push([range]{ run_chunks(*range); });
+    }
+    run_chunks(*range);
+
+    //Chunks Still Running on the Helpers
+    unique_lock<mutex> guard(range->lock);
+    range->finished.wait(guard,
+        [&range]{ return range->done == range->chunks; });
+}
+
+void OcrPool::push(const function<void()> &task)
+{
+    if (current_pool == this)
+    {
+        Worker *worker = workers[current_index];
+        lock_guard<mutex> guard(worker->lock);
+        worker->tasks.push_back(task);
+    }
+    else
+    {
+        lock_guard<mutex> guard(shared_lock);
+        shared.push_back(task);
+    }
+    queued++;
+    {
+        lock_guard<mutex> guard(sleep_lock);
+    }
+    wakeup.notify_one();
+}
+
+/*
+* Own tasks newest first, then the shared queue in order, then the oldest
+* task of another worker, the workers of the same node being tried first.
+*/
+bool OcrPool::take(int index, function<void()> &task)
+{
+    Worker *self = workers[index];
+    {
+        lock_guard<mutex> guard(self->lock);
+        if (!self->tasks.empty())
+        {
+            task = self->tasks.back();
+            self->tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    {
+        lock_guard<mutex> guard(shared_lock);
+        if (!shared.empty())
+        {
+            task = shared.front();
+            shared.pop_front();
+            queued--;
+            return true;
+        }
+    }
+
+    int n = workers.size();
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 1; i < n; i++)
+        {
+            Worker *victim = workers[(index + i) % n];
+            if ((victim->node == self->node) != (pass == 0))
+                continue;
+            lock_guard<mutex> guard(victim->lock);
+            if (!victim->tasks.empty())
+            {
+                task = victim->tasks.front();
+                victim->tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void OcrPool::run(int index)
+{
+    current_pool = this;
+    current_index = index;
+
+#ifdef __linux__
+    //Pinning
+    Worker *self = workers[index];
+    if (!self->cpus.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t i = 0; i < self->cpus.size(); i++)
+            CPU_SET(self->cpus[i], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    //Queued tasks are finished before the pool stops
+    function<void()> task;
+    while (true)
+    {
+        if (take(index, task))
+        {
+            task();
+            task = function<void()>();
+            continue;
+        }
+        unique_lock<mutex> guard(sleep_lock);
+        if (stopping && queued == 0)
+            return;
+        wakeup.wait(guard, [this]{ return queued > 0 || stopping; });
+    }
+}
+
+/*
+* Chooses the CPUs of every worker. With PLACE_NUMA the workers go round
+* the nodes, so the work is spread over all memory controllers, and a
+* worker may run on any CPU of its node. Only Linux is supported; other
+* systems leave the threads where the scheduler puts them.
+*/
+void OcrPool::place(int placement)
+{
+    if (placement == PLACE_NONE)
+        return;
+    vector<int> allowed = allowed_cpus();
+    if (allowed.empty())
+        return;
+    vector< vector<int> > nodes = numa_nodes(allowed);
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        Worker *worker = workers[i];
+        if (placement == PLACE_NUMA)
+        {
+            worker->node = i % nodes.size();
+            worker->cpus = nodes[worker->node];
+            continue;
+        }
+        int cpu = allowed[i % allowed.size()];
+        worker->cpus.assign(1, cpu);
+        for (size_t n = 0; n < nodes.size(); n++)
+        {
+            for (size_t c = 0; c < nodes[n].size(); c++)
+            {
+                if (nodes[n][c] == cpu)
+                    worker->node = n;
+            }
+        }
+    }
+}
+
+//Supplementary Code
+bool parse_placement(const char *name, int &placement)
+{
+    if (strcmp(name, "none") == 0)
+        placement = PLACE_NONE;
+    else if (strcmp(name, "cores") == 0)
+        placement = PLACE_CORES;
+    else if (strcmp(name, "numa") == 0)
+        placement = PLACE_NUMA;
+    else
+        return false;
+    return true;
+}
+
+vector<int> allowed_cpus()
+{
+    vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+/*
+* The allowed CPUs grouped by NUMA node, as listed in sysfs. Without
+* sysfs (or on a single node) all of them form one node.
+*/
+vector< vector<int> > numa_nodes(const vector<int> &allowed)
+{
+    vector< vector<int> > nodes;
+    char text[4096];
+    vector<int> online;
+    FILE *file = fopen("/sys/devices/system/node/online", "r");
+    if (file != NULL)
+    {
+        if (fgets(text, sizeof(text), file) != NULL)
+            online = parse_cpulist(text);
+        fclose(file);
+    }
+
+    for (size_t n = 0; n < online.size(); n++)
+    {
+        char path[64];
+        snprintf(path, sizeof(path),
+            "/sys/devices/system/node/node%d/cpulist", online[n]);
+        vector<int> cpus;
+        file = fopen(path, "r");
+        if (file == NULL)
+            continue;
+        if (fgets(text, sizeof(text), file) != NULL)
+            cpus = parse_cpulist(text);
+        fclose(file);
+
+        //Only the CPUs the process may run on
+        vector<int> usable;
+        for (size_t c = 0; c < cpus.size(); c++)
+        {
+            for (size_t a = 0; a < allowed.size(); a++)
+            {
+                if (allowed[a] == cpus[c])
+                    usable.push_back(cpus[c]);
+            }
+        }
+        if (!usable.empty())
+            nodes.push_back(usable);
+    }
+    if (nodes.empty())
+        nodes.push_back(allowed);
+    return nodes;
+}
+
+vector<int> parse_cpulist(const char *text)
+{
+    vector<int> cpus;
+    const char *p = text;
+    while (*p >= '0' && *p <= '9')
+    {
+        char *next;
+        int first = strtol(p, &next, 10);
+        int last = first;
+        if (*next == '-')
+            last = strtol(next + 1, &next, 10);
+        for (int cpu = first; cpu <= last; cpu++)
+            cpus.push_back(cpu);
+        p = next;
+        if (*p == ',')
+            p++;
+    }
+    return cpus;
+}
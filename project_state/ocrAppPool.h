@@ -0,0 +1,94 @@
+/***************************************************************
+ * Name:      ocrAppPool.h
+ * Purpose:   Defines the Work-Stealing Thread Pool shared by the
+ *            Engine, the Command Line Tools and the Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPPOOL_H
+#define OCRAPPPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+//Placement of the Workers
+#define PLACE_NONE 0  //Left to the operating system
+#define PLACE_CORES 1 //Worker i pinned to the i-th allowed CPU
+#define PLACE_NUMA 2  //Workers spread over the NUMA nodes, each pinned
+                      //to the CPUs of its node
+
+/*
+* A fixed set of threads, each with its own deque of tasks. A worker
+* takes its newest task first (what it just split off is still in its
+* cache) and, with nothing left, steals the oldest task of another worker,
+* trying the workers of its own NUMA node first. Tasks submitted from
+* outside the pool go to a shared queue that is served in order.
+*
+* parallel_for never starts threads. It hands out its range in chunks to
+* the calling thread and to whichever workers are idle, so parallel
+* loops nested in each other (plates, then letters, then rows) share the
+* same threads instead of multiplying them. The caller can always finish
+* its own range alone, so a nested loop cannot deadlock the pool.
+*/
+class OcrPool
+{
+public:
+    //0 threads means one per CPU
+    OcrPool(int threads = 0, int placement = PLACE_NONE);
+    ~OcrPool();
+
+    int size() const;
+    //Node of a worker, 0 without NUMA placement
+    int node_of(int worker) const;
+
+    //Runs the task on a worker. The pool does not wait for it
+    void submit(const function<void()> &task);
+    //Calls body(first, last) over [begin, end) in chunks of at most grain
+    //(0 for an even split) and returns when all of them are done
+    void parallel_for(int begin, int end, int grain,
+        const function<void(int, int)> &body);
+
+    //Index of the worker running the caller, -1 outside the pool
+    static int current_worker();
+
+private:
+    struct Worker
+    {
+        mutex lock;
+        deque< function<void()> > tasks;
+        thread handle;
+        vector<int> cpus;   //CPUs the worker is pinned to, empty if none
+        int node;
+    };
+
+    //Pool Functions
+    void run(int index);
+    bool take(int index, function<void()> &task);
+    void push(const function<void()> &task);
+    void place(int placement);
+
+    //Variables
+    vector<Worker *> workers;
+    mutex shared_lock;
+    deque< function<void()> > shared;  //Tasks from outside the pool
+    atomic<int> queued;                //Tasks in all of the queues
+    mutex sleep_lock;
+    condition_variable wakeup;
+    atomic<bool> stopping;
+};
+
+//Reads "none", "cores" or "numa" as given on the command line
+bool parse_placement(const char *name, int &placement);
+//Reads a list like "0-3,8-11" as found in sysfs
+vector<int> parse_cpulist(const char *text);
+
+#endif
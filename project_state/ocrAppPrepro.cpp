@@ -7,48 +7,194 @@
  * Copyright: 
  * License:
  **************************************************************/
-#include <wx/wxprec.h>
-#ifndef WX_PRECOMP
-#include <wx/wx.h>
-#endif
+#include "ocrAppPrepro.h"
+#include "ocrAppMatch.h"
+#include "ocrAppDecode.h"
+#include "ocrAppPool.h"
 #include <string.h>
 #include <sstream>
 #include <stdlib.h>
 
 //Functions
-int compare (const void * a, const void * b);
-void color_inversion (wxImage &image3);
+void color_inversion (OcrImage &image3, OcrPool *pool);
+bool letter_corners(const OcrView &image3, int edge[4][2]);
+int segmentation_line(const OcrView &image3, int top, int bottom,
+    const vector<int> &columnState, OcrView inputs [52], int h);
+int tile_rows(const OcrImage &image);
+double otsu_separation(const int histogram[256]);
+void for_tiles(int height, int rows, OcrPool *pool,
+    const function<void(int, int)> &body);
 
 //Definitions
 #define W 500
 #define H 500
+#define TILE_BYTES (64 * 1024) //Rows processed together stay in L2
+#define PLANE_MARGIN 1.25 //How much better than luma another plane must be
+#define PLANE_STEP 2 //Rows and columns between the pixels color_plane counts
+#define LINE_RATIO 0.3 //Bands of rows thinner than this part of the
+                       //tallest are dots or accents, not lines
+#define QUALITY_STEP 4 //Rows and columns between the pixels whose
+                       //Laplacian and level frame_quality takes
+#define SPREAD_TAIL 1  //Percent of the pixels left out at either end of
+                       //the spread
+
+const char *const plane_names[NUM_PLANES] =
+{
+    "luma", "red", "green", "blue", "red-green", "blue-yellow"
+};
 
 /* 
 * This part of the code grayscales the image so that it would be prepared for thresholding.
 * The process is easily done, and is acquired by multiplying the RGB constants of each pixel by
 * 0.21, 0.72, and 0.07. Then, the luminosity is acquired by adding all of these
 * and applying this as the RGB color of each pixel.
+*
+* Each product only depends on one byte, so they are computed once into
+* tables (with the same truncation to int as before) and the frame is
+* walked row by row, in tiles of rows that may go to different threads.
 */
 
-void grayscale(wxImage &image1)
+void grayscale(OcrImage &image1, OcrPool *pool)
 {
     //Grayscale Filter
-    int red, green, blue, lum;
-    
-    for (int x = 0; x < image1.GetWidth(); x++)
-    {
-        for (int y = 0; y < image1.GetHeight(); y++)
-        { 
-          red = image1.GetRed(x,y)*0.21;
-          green = image1.GetGreen(x,y)*0.72;
-          blue = image1.GetBlue(x,y)*0.07;
-          lum = red + green + blue;
-          image1.SetRGB(x, y, lum, lum, lum);
+    int red[256], green[256], blue[256];
+    for (int v = 0; v < 256; v++)
+    {
+        red[v] = v*0.21;
+        green[v] = v*0.72;
+        blue[v] = v*0.07;
+    }
+
+    int windowx = image1.GetWidth();
+    unsigned char *data = image1.GetData();
+    for_tiles(image1.GetHeight(), tile_rows(image1), pool,
+        [&](int first, int last)
+    {
+        unsigned char *pixel = data + (size_t)first * windowx * 3;
+        unsigned char *end = data + (size_t)last * windowx * 3;
+        for (; pixel < end; pixel += 3)
+        {
+            int lum = red[pixel[0]] + green[pixel[1]] + blue[pixel[2]];
+            pixel[0] = pixel[1] = pixel[2] = lum;
+        }
+    });
+}
+
+/*
+* Plates are green, black, red or blue on white, and black on yellow, and
+* for some of them the fixed weights of grayscale() leave little between
+* the text and the background. color_plane samples the RGB data, and
+* every sampled pixel adds to a histogram of each projection (luma, the
+* three channels and two color differences). The projection whose
+* histogram is best split in two, by Otsu's between-class variance, is
+* then written as the gray plane in a single pass over the frame. Gray
+* images have the same contrast in luma and in every channel, so luma is
+* kept unless another projection is PLANE_MARGIN times better, and those
+* images come out as grayscale() makes them.
+*/
+int color_plane(OcrImage &image, OcrPool *pool)
+{
+    int red[256], green[256], blue[256];
+    for (int v = 0; v < 256; v++)
+    {
+        red[v] = v*0.21;
+        green[v] = v*0.72;
+        blue[v] = v*0.07;
+    }
+
+    int windowx = image.GetWidth();
+    int windowy = image.GetHeight();
+    unsigned char *data = image.GetData();
+    if (windowx <= 0 || windowy <= 0)
+        return PLANE_LUMA;
+
+    //Histograms of Every Projection, per Tile of Rows. Only every other
+    //pixel of every other row is counted, which is plenty to tell the
+    //contrast and leaves the writing as the only full pass
+    int rows = tile_rows(image);
+    int tiles = (windowy + rows - 1) / rows;
+    vector<int> tile_histo(tiles * NUM_PLANES * 256, 0);
+    for_tiles(windowy, rows, pool, [&](int first, int last)
+    {
+        int *histo = &tile_histo[(first / rows) * NUM_PLANES * 256];
+        int y = first + (PLANE_STEP - first % PLANE_STEP) % PLANE_STEP;
+        for (; y < last; y += PLANE_STEP)
+        {
+            const unsigned char *row = data + (size_t)y * windowx * 3;
+            int x = 0;
+            while (x < windowx)
+            {
+                //Runs of One Color (Most of a Plate) are Counted at Once.
+                //The column is stepped rather than the pointer, which
+                //would overshoot the end of the last row
+                const unsigned char *pixel = row + x * 3;
+                int r = pixel[0], g = pixel[1], b = pixel[2];
+                int run = 0;
+                for (; x < windowx && row[x * 3] == r &&
+                    row[x * 3 + 1] == g && row[x * 3 + 2] == b;
+                    x += PLANE_STEP)
+                    run++;
+                histo[PLANE_LUMA * 256 + red[r] + green[g] + blue[b]] += run;
+                histo[PLANE_RED * 256 + r] += run;
+                histo[PLANE_GREEN * 256 + g] += run;
+                histo[PLANE_BLUE * 256 + b] += run;
+                histo[PLANE_RED_GREEN * 256 + ((r - g + 255) >> 1)] += run;
+                histo[PLANE_BLUE_YELLOW * 256 +
+                    ((2*b - r - g + 510) >> 2)] += run;
+            }
+        }
+    });
+
+    //Choice of the Projection
+    int plane = PLANE_LUMA;
+    double best = 0;
+    for (int p = 0; p < NUM_PLANES; p++)
+    {
+        int histogram[256] = {0};
+        for (int t = 0; t < tiles; t++)
+        {
+            for (int i = 0; i < 256; i++)
+                histogram[i] += tile_histo[(t * NUM_PLANES + p) * 256 + i];
+        }
+        double separation = otsu_separation(histogram);
+        if (p == PLANE_LUMA)
+            best = separation * PLANE_MARGIN;
+        else if (separation > best)
+        {
+            best = separation;
+            plane = p;
         }
     }
+
+    //Writing of the Plane
+    if (plane == PLANE_LUMA)
+    {
+        grayscale(image, pool);
+        return plane;
+    }
+    for_tiles(windowy, rows, pool, [&](int first, int last)
+    {
+        unsigned char *pixel = data + (size_t)first * windowx * 3;
+        unsigned char *end = data + (size_t)last * windowx * 3;
+        for (; pixel < end; pixel += 3)
+        {
+            int r = pixel[0], g = pixel[1], b = pixel[2];
+            int lum;
+            switch (plane)
+            {
+            case PLANE_RED: lum = r; break;
+            case PLANE_GREEN: lum = g; break;
+            case PLANE_BLUE: lum = b; break;
+            case PLANE_RED_GREEN: lum = (r - g + 255) >> 1; break;
+            default: lum = (2*b - r - g + 510) >> 2; break;
+            }
+            pixel[0] = pixel[1] = pixel[2] = lum;
+        }
+    });
+    return plane;
 }
  
-void threshold(wxImage &image2, bool isLetter)
+int threshold(OcrImage &image2, bool isLetter, OcrPool *pool)
 {
     /* Otsu's Binarization was applied for the thresholding and binarization.  
     * 
@@ -56,15 +202,31 @@ void threshold(wxImage &image2, bool isLetter)
     */
     int windowx = image2.GetWidth();
     int windowy = image2.GetHeight();
-    int histoarray[256], sort_histoarray[256];
+    int histoarray[256] = {0}, sort_histoarray[256];
+    unsigned char *data = image2.GetData();
+
+    //Tiles of Rows, each with its own Histogram and Counts
+    int rows = tile_rows(image2);
+    int tiles = (windowy + rows - 1) / rows;
+    vector<int> tile_histo(tiles * 256 + 1, 0);
+    vector<int> tile_black(tiles + 1, 0);
     
     //Generation of Histogram    
-    for (int x = 0; x < windowx ; x++)
+    for_tiles(windowy, rows, pool, [&](int first, int last)
     {
-        for (int y = 0; y < windowy ; y++)
+        int *histo = &tile_histo[(first / rows) * 256];
+        const unsigned char *pixel = data + (size_t)first * windowx * 3;
+        const unsigned char *end = data + (size_t)last * windowx * 3;
+        for (; pixel < end; pixel += 3)
         {
-            histoarray[image2.GetRed(x,y)]++; 
+            histo[pixel[0]]++;
         }
+    });
+    //The Sums do not Depend on the Order, so Any Split Gives the Same
+    for (int t = 0; t < tiles; t++)
+    {
+        for (int i = 0; i < 256; i++)
+            histoarray[i] += tile_histo[t * 256 + i];
     }
     
     //Determination of Peaks
@@ -74,30 +236,19 @@ void threshold(wxImage &image2, bool isLetter)
     }
     qsort(sort_histoarray, 256, sizeof(int), compare);
     
-    int peak1, peak2;
-    int num_of_maxa = 1;
-    int num_of_maxb = 1;
-    
-    for (int i = 0; i < 255; i++)
-    {
-        if (sort_histoarray[255] == sort_histoarray[i])
-            num_of_maxa++;        
-    }
-    for (int i = 0; i < 254; i++)
+    //The two most frequent levels. When counts are tied (a blank or a
+    //two-level image), the highest of the tied levels is taken, so the
+    //peaks are always two different levels
+    int peak1 = 0, peak2 = 0;
+    for (int i = 0; i < 256; i++)
     {
-        if (sort_histoarray[254] == sort_histoarray[i])
-            num_of_maxb++;        
+        if(sort_histoarray[255] == histoarray[i])
+            peak1 = i;
     }
-    
-    if(num_of_maxa == 1 && num_of_maxb == 1)
+    for (int i = 0; i < 256; i++)
     {
-        for (int i = 0; i < 256; i++)
-        {
-            if(sort_histoarray[255] == histoarray[i])
-                peak1 = i;
-            if(sort_histoarray[254] == histoarray[i])
-                peak2 = i;
-        }
+        if(sort_histoarray[254] == histoarray[i] && i != peak1)
+            peak2 = i;
     }
     
     //Determination of Threshold
@@ -108,31 +259,130 @@ void threshold(wxImage &image2, bool isLetter)
     int white = 0;
     
     //Binarization Proper
-    for (int x = 0; x < windowx ; x++)
+    for_tiles(windowy, rows, pool, [&](int first, int last)
     {
-        for (int y = 0; y < windowy ; y++)
-        {   
-            if(image2.GetRed(x,y) <= thr)
-            {
-                image2.SetRGB(x, y, 0, 0, 0);
-                black++;
-            }   
-            else if(image2.GetRed(x,y) > thr)
-            {
-                image2.SetRGB(x, y, 255, 255, 255);
-                white++;
-            }
+        int count = 0;
+        unsigned char *pixel = data + (size_t)first * windowx * 3;
+        unsigned char *end = data + (size_t)last * windowx * 3;
+        for (; pixel < end; pixel += 3)
+        {
+            int dark = pixel[0] <= thr;
+            pixel[0] = pixel[1] = pixel[2] = dark ? 0 : 255;
+            count += dark;
         }
+        tile_black[first / rows] = count;
+    });
+    for (int t = 0; t < tiles; t++)
+    {
+        black += tile_black[t];
     }
+    white = windowx * windowy - black;
     
     //Color Inversion
     if (black > white && isLetter == 0)
     {
-        color_inversion(image2);
+        color_inversion(image2, pool);
     } 
+    return thr;
 }
 
-void segmentation(wxImage &image3)
+/*
+* Sharpness is the variance of the Laplacian (4 times a pixel less its
+* four neighbours): edges in focus give large values of either sign, and
+* blur spreads them into small ones. The frame is still in color, so
+* color_plane has not picked the projection yet; each channel is measured
+* and the best one kept, as text that stands out in any of them is found
+* by color_plane. Only every QUALITY_STEP-th pixel of every
+* QUALITY_STEP-th row is taken, so a frame is judged on a sixteenth of it
+* before any full pass.
+*/
+void frame_quality(const OcrImage &image, FrameQuality &quality)
+{
+    int windowx = image.GetWidth();
+    int windowy = image.GetHeight();
+    const unsigned char *data = image.GetData();
+    int histogram[3][256];
+    double sums[3][2];
+    memset(histogram, 0, sizeof(histogram));
+    memset(sums, 0, sizeof(sums));
+    long count = 0;
+    for (int y = 1; y < windowy - 1; y += QUALITY_STEP)
+    {
+        const unsigned char *row = data + (size_t)y * windowx * 3;
+        for (int x = 1; x < windowx - 1; x += QUALITY_STEP)
+        {
+            const unsigned char *p = row + x * 3;
+            for (int c = 0; c < 3; c++)
+            {
+                int laplace = 4 * p[c] - p[c - 3] - p[c + 3] -
+                    p[c - windowx * 3] - p[c + windowx * 3];
+                sums[c][0] += laplace;
+                sums[c][1] += (double)laplace * laplace;
+                histogram[c][p[c]]++;
+            }
+            count++;
+        }
+    }
+
+    quality.sharpness = 0;
+    quality.spread = 0;
+    for (int c = 0; c < 3 && count > 0; c++)
+    {
+        double mean = sums[c][0] / count;
+        quality.sharpness = max(quality.sharpness,
+            sums[c][1] / count - mean * mean);
+
+        //Levels Between the Tails: the first beyond the lower one and the
+        //first that reaches the upper one. A sample of fewer than 100
+        //pixels has no tails, and its darkest and brightest are taken
+        long tail = count * SPREAD_TAIL / 100;
+        long seen = 0;
+        int low = -1, high = -1;
+        for (int i = 0; i < 256 && high < 0; i++)
+        {
+            seen += histogram[c][i];
+            if (low < 0 && seen > tail)
+                low = i;
+            if (seen >= count - tail)
+                high = i;
+        }
+        if (low >= 0 && high > low)
+            quality.spread = max(quality.spread, high - low);
+    }
+}
+
+//Isolates the character given the corners of the character. The image
+//is thresholded, so its three channels are the same and copying the
+//window row by row gives the gray pixels
+void segmentation(OcrImage &image3)
+{
+    OcrView window = segment_window(image3);
+    if (window.GetWidth() == image3.GetWidth() &&
+        window.GetHeight() == image3.GetHeight())
+    {
+        return;
+    }
+    image3 = window.Copy();
+}
+
+OcrView segment_window(const OcrImage &image3)
+{
+    int edge[4][2];
+    
+    //A Blank Image has Nothing to Isolate
+    if (!letter_corners(OcrView(image3), edge))
+    {
+        return OcrView(image3);
+    }
+    
+    //Width and Height of the Character
+    int n_width = edge[1][0] - edge[0][0] + 1;
+    int n_height = edge[2][1] - edge[0][1] + 1;
+    return OcrView(image3, edge[0][0], edge[0][1], n_width, n_height);
+}
+
+//Finds the corners of the black of the view, false if it has none
+bool letter_corners(const OcrView &image3, int edge[4][2])
 {
     int windowx = image3.GetWidth();
     int windowy = image3.GetHeight();
@@ -145,7 +395,11 @@ void segmentation(wxImage &image3)
              ...                   ....
      [3][0],[3][1] --------- [2][0],[2][1]
     */
-    int edge[4][2]; 
+    for (int p = 0; p < 4; p++)
+    {
+        edge[p][0] = -1;
+        edge[p][1] = -1;
+    }
     
     //Corner Detection
     for (int i = 0; i < windowx ; i++)
@@ -198,131 +452,317 @@ void segmentation(wxImage &image3)
             }
         }
     }
-    
-    //Width and Height of the Character
-    int n_width = edge[1][0] - edge[0][0] + 1;
-    int n_height = edge[2][1] - edge[0][1] + 1;
-    
-    if(n_width == windowx && n_height == windowy)
+    return edge[0][0] >= 0;
+}
+
+/*
+* Level 1 Segmentation separates the lines of text, for plates with two
+* rows of letters (motorcycles and some older formats), and Level 2 the
+* letters of every line. The rows with black and the columns with black
+* are found in the same pass over the image. A plate of one line (a
+* single band of rows) is cut with those columns directly; only a plate
+* of several lines reads the rows of each line again for its columns,
+* so the image is read at most twice, all lines together.
+*
+* Bands of rows much thinner than the tallest are not lines of their
+* own, but the dots of i and j, accents or a dash, and join the band
+* nearest to them. Letters are returned line by line, top to bottom, as
+* windows of the image; segmentation_word copies them out at W/5 x H/5.
+*/
+int segmentation_word(OcrImage &image3, OcrImage inputs [52] )
+{
+    OcrView letters[MAX_LETTERS];
+    int h = segment_letters(image3, letters);
+    for (int a = 0; a < h; a++)
     {
-        return;
+        inputs[a] = letters[a].Scale(W/5, H/5);
     }
-    
-    //Isolates the character given the corners of the character
-    wxImage temp;
-    temp.Create(n_width,n_height);
-    int lums;
-    
-    for (int x = edge[0][0]; x < edge[0][0] + n_width; x++)
+    return h;
+}
+
+int segment_letters(const OcrView &image3, OcrView inputs [52] )
+{
+    //Level 1 Segmentation
+    //Separates the lines on a per row basis
+    int windowx = image3.GetWidth();
+    int windowy = image3.GetHeight();
+    vector<int> rowState(windowy, 1);    //1 for background, as columns
+    vector<int> columnState(windowx, 1); //whether a column has black or not
+    int words = (windowx + 63) / 64;
+    vector<uint64_t> blackBits(windowy * words, 0); //black columns by row
+
+    //Checks every row and column whether it has a black pixel or not,
+    //keeping the black columns of each row for the bands of lines
+    for (int j = 0; j < windowy; j++)
+    {
+        const unsigned char *row = image3.GetRow(j);
+        uint64_t *bits = &blackBits[j * words];
+        for (int i = 0; i < windowx; i++)
+        {
+            if (row[i * 3] != 255)
+            {
+                rowState[j] = 0;
+                columnState[i] = 0;
+                bits[i / 64] |= (uint64_t)1 << (i % 64);
+            }
+        }
+    }
+
+    //Bands of Rows with Black, Separated by Blank Rows
+    vector<int> tops, bottoms;
+    for (int j = 0; j < windowy; j++)
+    {
+        if (rowState[j] == 0 && (j == 0 || rowState[j - 1] == 1))
+            tops.push_back(j);
+        if (rowState[j] == 0 && (j == windowy - 1 || rowState[j + 1] == 1))
+            bottoms.push_back(j + 1);
+    }
+
+    //Thin Bands Join their Nearest Neighbour
+    while (tops.size() > 1)
     {
-        for (int y = edge[0][1]; y < edge[0][1] + n_height; y++)
+        int tallest = 0, thinnest = 0;
+        for (size_t b = 0; b < tops.size(); b++)
         {
-          lums = image3.GetRed(x,y);
-          temp.SetRGB(x-edge[0][0], y-edge[0][1], lums, lums, lums);
+            tallest = max(tallest, bottoms[b] - tops[b]);
+            if (bottoms[b] - tops[b] < bottoms[thinnest] - tops[thinnest])
+                thinnest = b;
         }
+        if (bottoms[thinnest] - tops[thinnest] >= tallest * LINE_RATIO)
+            break;
+        int b = thinnest;
+        bool up = b > 0 && (b + 1 == (int)tops.size() ||
+            tops[b] - bottoms[b - 1] <= tops[b + 1] - bottoms[b]);
+        if (up)
+            b--;
+        tops.erase(tops.begin() + b + 1);
+        bottoms.erase(bottoms.begin() + b);
     }
-    image3 = temp;
-}
 
-int segmentation_word(wxImage &image3, wxImage inputs [52] )
-{
     //Level 2 Segmentation
-    //Separates the letters on a per column basis
-    int windowx = image3.GetWidth();
-    int windowy = image3.GetHeight();
-    int columnState[windowx]; //whether a column has black or not
-    int sum;
+    //One Line Keeps the Whole Height and the Columns Found Already
+    if (tops.size() <= 1)
+        return segmentation_line(image3, 0, windowy, columnState, inputs, 0);
 
-    //Color Inversion
-    color_inversion(image3);
-    
-    //Checks column whether it has a black pixel or not 
-    for (int i = 0; i < windowx ; i++)
+    //Each Band's Columns are the Black Columns of its Rows, ORed
+    int h = 0;    //Counter for Number of Segmented Letters
+    vector<uint64_t> bandBits(words);
+    for (size_t b = 0; b < tops.size() && h < MAX_LETTERS; b++)
     {
-        sum = 0;
-        for (int j = 0; j < windowy ; j++)
+        fill(bandBits.begin(), bandBits.end(), 0);
+        for (int j = tops[b]; j < bottoms[b]; j++)
         {
-            sum += image3.GetRed(i,j);
+            const uint64_t *bits = &blackBits[j * words];
+            for (int k = 0; k < words; k++)
+                bandBits[k] |= bits[k];
         }
-        
-        if (sum == 0) //Black
-            columnState[i] = 1; //Part of the Background
-        else          //White
-            columnState[i] = 0; //Part of the Character
+        for (int i = 0; i < windowx; i++)
+            columnState[i] = (bandBits[i / 64] >> (i % 64) & 1) ? 0 : 1;
+        h = segmentation_line(image3, tops[b], bottoms[b], columnState,
+            inputs, h);
     }
-    
-    //Reverse Color Inversion
-    color_inversion(image3);
-    
+    return h;
+}
+
+//Separates the letters of rows top to bottom - 1 on a per column basis,
+//after the h letters found already. Returns the new number of letters
+int segmentation_line(const OcrView &image3, int top, int bottom,
+    const vector<int> &columnState, OcrView inputs [52], int h)
+{
+    int windowx = image3.GetWidth();
+    int windowy = bottom - top;
+
     //Segmentation Proper: The Concept
-    //The principle is that a wxImage variable is created only when 
-    //it is the first column with a black, and determines the column 
-    //as to which it is all white. Given this, the variable for the 
-    //letter is created with the determined width and length. The code 
-    //then toggles between foreground and background, as to which it 
-    //will only copy values, when it has been determined to be the 
-    //foreground.
-    int n_width;
-    int h = 0;    //Counter for Number of Segmented Letters
-    int val = 0;  //Variable for Luminance
-    int l = 0;    //Counter for x-axis location in letter
-    
-    int init_state_fg = 0;
-    int init_state_bg = 0;
+    //A letter starts at the first column with a black and ends at the
+    //first column after it that is all white. It is the window of the
+    //image between the two, over the rows of the line; nothing is
+    //copied until the letter is normalized.
+    int start = -1;  //First Column of the Current Letter
     
-    for (int i = 0; i < windowx; i++)
+    for (int i = 0; i <= windowx; i++)
     {
         //For Columns with a Black Pixel
-        if(columnState[i] == 0)
+        if (i < windowx && columnState[i] == 0)
         {
-            //If Initial Column, Initialize Values
-            if (init_state_fg == 0)
-            {
-                //Computation for Width
-                for(int k = i; k < windowx; k++)
-                {
-                    if(columnState[k] == 1 || k == windowx - 1)
-                    {
-                         n_width = k - i;
-                         if (k == windowx - 1)
-                            n_width++;
-                         k = windowx;    
-                    }
-                }
-                inputs[h].Create(n_width, windowy);
-                init_state_fg = 1;
-                init_state_bg = 0;
-            }
+            if (start < 0)
+                start = i;
+        }
+        
+        //For Columns with no Black Pixel, and Past the Last Column
+        //Initiates a Letter Switch, Once a Letter was Started
+        else if (start >= 0)
+        {
+            inputs[h] = image3.Window(start, top, i - start, windowy);
+            start = -1;
+            h++;
             
-            //Copy Proper
-            for(int j = 0; j < windowy; j++)
+            //No Room for More Letters
+            if (h == MAX_LETTERS)
+                return h;
+        }
+    }
+    //Sets the maximum value of used variables based on h
+    return h;
+}
+
+/*
+* What segmentation_word, segmentation and rescale_glyph give together,
+* read straight from the window of the plate. The letter is sampled to
+* W/5 x H/5 first, as segmentation_word does, and the corners of its
+* black are found in that sampling; the glyph then samples the corners'
+* rectangle of it. Both steps are tables of source columns and rows, so
+* the two samplings compose into one, and only the glyph is written.
+*/
+void normalize_glyph(const OcrView &letter, int size, OcrImage &glyph)
+{
+    const int across = W/5, down = H/5;
+    if (!letter.IsOk() || !glyph.Create(size, size))
+    {
+        glyph.Destroy();
+        return;
+    }
+
+    //Sampling of the Letter at W/5 x H/5
+    int columns[W/5], rows[H/5];
+    unsigned long x_delta = ((unsigned long)letter.GetWidth() << 16) / across;
+    unsigned long y_delta = ((unsigned long)letter.GetHeight() << 16) / down;
+    unsigned long x = 0, y = 0;
+    for (int i = 0; i < across; i++)
+    {
+        columns[i] = (x >> 16) * 3;
+        x += x_delta;
+    }
+    for (int j = 0; j < down; j++)
+    {
+        rows[j] = y >> 16;
+        y += y_delta;
+    }
+
+    //Corners of its Black, as segmentation Finds Them
+    int left = across, right = -1, top = down, bottom = -1;
+    for (int j = 0; j < down; j++)
+    {
+        const unsigned char *line = letter.GetRow(rows[j]);
+        for (int i = 0; i < across; i++)
+        {
+            if (line[columns[i]] == 0)
             {
-                val = image3.GetRed(i,j);
-                inputs[h].SetRGB(l,j,val,val,val);
+                left = min(left, i);
+                right = max(right, i);
+                top = min(top, j);
+                bottom = max(bottom, j);
             }
-            l++;
-            
         }
-        
-        //For Columns with no Black Pixel
-        //Initiates a Letter Switch
-        else if(columnState[i] == 1 && init_state_bg == 0 )
+    }
+    //segmentation Keeps a Blank or Full Letter as it is, and Gives the
+    //Red of the Others
+    bool cropped = right >= 0 &&
+        (right - left + 1 != across || bottom - top + 1 != down);
+    if (!cropped)
+    {
+        left = 0;
+        top = 0;
+        right = across - 1;
+        bottom = down - 1;
+    }
+
+    //The Glyph Samples the Corners' Rectangle
+    vector<int> glyphColumns(size);
+    x_delta = ((unsigned long)(right - left + 1) << 16) / size;
+    y_delta = ((unsigned long)(bottom - top + 1) << 16) / size;
+    x = 0;
+    for (int i = 0; i < size; i++)
+    {
+        glyphColumns[i] = columns[left + (x >> 16)];
+        x += x_delta;
+    }
+    unsigned char *target = glyph.GetData();
+    y = 0;
+    for (int j = 0; j < size; j++)
+    {
+        const unsigned char *line = letter.GetRow(rows[top + (y >> 16)]);
+        for (int i = 0; i < size; i++)
         {
-            inputs[h].Rescale(W/5, H/5);  
-            init_state_fg = 0;
-            init_state_bg = 1;
-            h++;
-            l = 0; 
+            const unsigned char *pixel = line + glyphColumns[i];
+            target[0] = pixel[0];
+            target[1] = cropped ? pixel[0] : pixel[1];
+            target[2] = cropped ? pixel[0] : pixel[2];
+            target += 3;
         }
-        
-        //For Last Column
-        if (i == windowx - 1)
-        { 
-            inputs[h].Rescale(W/5, H/5);
+        y += y_delta;
+    }
+}
+
+/*
+* The same resampling as OcrImage::Rescale (16.16 fixed point, nearest
+* neighbour), but with the glyph size as a template argument. The source
+* column of every target column is computed once, and with SIZE known the
+* copy loop has a constant trip count, so the compiler unrolls it.
+* rescale_glyph uses the copy made for the size when there is one.
+*/
+template<int SIZE>
+void rescale_fixed(OcrImage &image)
+{
+    int width = image.GetWidth();
+    int height = image.GetHeight();
+    OcrImage result;
+    if (!image.IsOk() || !result.Create(SIZE, SIZE))
+    {
+        image = result;
+        return;
+    }
+
+    unsigned long x_delta = ((unsigned long)width << 16) / SIZE;
+    unsigned long y_delta = ((unsigned long)height << 16) / SIZE;
+    int columns[SIZE];
+    unsigned long x = 0;
+    for (int i = 0; i < SIZE; i++)
+    {
+        columns[i] = (x >> 16) * 3;
+        x += x_delta;
+    }
+
+    const unsigned char *source = image.GetData();
+    unsigned char *target = result.GetData();
+    unsigned long y = 0;
+    for (int j = 0; j < SIZE; j++)
+    {
+        const unsigned char *line = source + (y >> 16) * width * 3;
+        for (int i = 0; i < SIZE; i++)
+        {
+            target[0] = line[columns[i]];
+            target[1] = line[columns[i] + 1];
+            target[2] = line[columns[i] + 2];
+            target += 3;
         }
+        y += y_delta;
+    }
+    image = result;
+}
+
+void rescale_glyph(OcrImage &image, int size)
+{
+    switch (size)
+    {
+    case GLYPH_SMALL:
+        rescale_fixed<GLYPH_SMALL>(image);
+        break;
+    case GLYPH_MEDIUM:
+        rescale_fixed<GLYPH_MEDIUM>(image);
+        break;
+    case GLYPH_LARGE:
+        rescale_fixed<GLYPH_LARGE>(image);
+        break;
+    case GLYPH_LARGE/2:
+        rescale_fixed<GLYPH_LARGE/2>(image);
+        break;
+    case GLYPH_LARGE/4:
+        rescale_fixed<GLYPH_LARGE/4>(image);
+        break;
+    default:
+        image.Rescale(size, size);
+        break;
     }
-    //Sets the maximum value of used variables based on h
-    return ++h;
 }
 
 //Supplemetary Code
@@ -331,19 +771,80 @@ int compare (const void * a, const void * b)
     return ( *(int*)a - *(int*)b );
 }
 
-void color_inversion (wxImage &image3)
+//Otsu's between-class variance at the best split of the histogram, a
+//measure of contrast that does not depend on the number of pixels
+double otsu_separation(const int histogram[256])
+{
+    double total = 0, sum = 0;
+    for (int i = 0; i < 256; i++)
+    {
+        total += histogram[i];
+        sum += (double)i * histogram[i];
+    }
+    if (total == 0)
+        return 0;
+
+    double weight = 0, below = 0, best = 0;
+    for (int i = 0; i < 255; i++)
+    {
+        weight += histogram[i];
+        below += (double)i * histogram[i];
+        if (weight == 0 || weight == total)
+            continue;
+        double mean_below = below / weight;
+        double mean_above = (sum - below) / (total - weight);
+        double share = weight / total;
+        double variance = share * (1 - share) *
+            (mean_below - mean_above) * (mean_below - mean_above);
+        if (variance > best)
+            best = variance;
+    }
+    return best;
+}
+
+void color_inversion (OcrImage &image3, OcrPool *pool)
 {
     int windowx = image3.GetWidth();
-    int windowy = image3.GetHeight();
-    
-    for (int i = 0; i < windowx ; i++)
+    unsigned char *data = image3.GetData();
+
+    //Only Black and White are Swapped, Grays are Kept
+    for_tiles(image3.GetHeight(), tile_rows(image3), pool,
+        [&](int first, int last)
     {
-        for (int j = 0; j < windowy ; j++)
+        unsigned char *pixel = data + (size_t)first * windowx * 3;
+        unsigned char *end = data + (size_t)last * windowx * 3;
+        for (; pixel < end; pixel += 3)
         {
-            if(image3.GetRed(i,j) == 255) //If white, turn black
-                image3.SetRGB(i, j, 0, 0, 0);
-            else if(image3.GetRed(i,j) == 0) //If black, turn white
-                image3.SetRGB(i, j, 255, 255, 255);
+            if(pixel[0] == 255) //If white, turn black
+                pixel[0] = pixel[1] = pixel[2] = 0;
+            else if(pixel[0] == 0) //If black, turn white
+                pixel[0] = pixel[1] = pixel[2] = 255;
         }
+    });
+}
+
+/*
+* Rows per tile, so that a tile is about TILE_BYTES. Tiles only ever
+* split the frame between rows, and every pixel is computed the same way
+* in any tile, so the result is the same as a single pass.
+*/
+int tile_rows(const OcrImage &image)
+{
+    int rows = TILE_BYTES / (image.GetWidth() * 3 + 1);
+    return (rows > 0) ? rows : 1;
+}
+
+void for_tiles(int height, int rows, OcrPool *pool,
+    const function<void(int, int)> &body)
+{
+    if (height <= 0)
+        return;
+    if (pool == NULL || height <= rows)
+    {
+        //Tile by Tile on this Thread
+        for (int first = 0; first < height; first += rows)
+            body(first, (first + rows < height) ? first + rows : height);
+        return;
     }
+    pool->parallel_for(0, height, rows, body);
 }
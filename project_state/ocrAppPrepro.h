@@ -7,16 +7,62 @@
  * Copyright: 
  * License:
  **************************************************************/
+#ifndef OCRAPPPREPRO_H
+#define OCRAPPPREPRO_H
+
+#include "ocrImage.h"
+#include <stddef.h>
+
+class OcrPool;
+
+//Projections of the RGB Data Compared by color_plane
+#define PLANE_LUMA 0        //0.21 R + 0.72 G + 0.07 B, as grayscale
+#define PLANE_RED 1
+#define PLANE_GREEN 2
+#define PLANE_BLUE 3
+#define PLANE_RED_GREEN 4   //(R - G) / 2, red on green and the reverse
+#define PLANE_BLUE_YELLOW 5 //(2B - R - G) / 4, yellow on blue and the reverse
+#define NUM_PLANES 6
+extern const char *const plane_names[NUM_PLANES];
+
+//Quality of the Best Channel of a Color Frame, to Tell Hopeless Frames
+//before Filtering
+struct FrameQuality
+{
+    double sharpness;    //Variance of the Laplacian, which blur lowers
+    int spread;          //Levels from the 1st to the 99th percentile
+};
+
 //Preprocessing Functions
-//Applies Grayscale Filter
-void grayscale(wxImage &image); 
-//Otsu's Binarization
-void threshold(wxImage &image, bool isLetter); 
+//Applies Grayscale Filter, in Tiles of Rows on the Pool if Given
+void grayscale(OcrImage &image, OcrPool *pool = NULL); 
+//Replaces the Image by its Projection with the Most Contrast between
+//Text and Background, Luma Unless Another is Clearly Better. Returns
+//the Projection
+int color_plane(OcrImage &image, OcrPool *pool = NULL);
+//Otsu's Binarization, in Tiles of Rows on the Pool if Given.
+//Returns the Threshold
+int threshold(OcrImage &image, bool isLetter, OcrPool *pool = NULL); 
+//Measures a Color Image on a Sample of its Pixels
+void frame_quality(const OcrImage &image, FrameQuality &quality);
 //Segments the Image
-void segmentation(wxImage &image); 
-//Segments the Words and Returns Number of Letters
-int segmentation_word(wxImage &image, wxImage inputs [52] ); 
+void segmentation(OcrImage &image); 
+//The Window of the Image that segmentation Copies Out, the Whole Image
+//if it has no Black
+OcrView segment_window(const OcrImage &image);
+//Segments the Words, Line by Line for Plates with Several Lines of
+//Text, and Returns Number of Letters, at most MAX_LETTERS
+int segmentation_word(OcrImage &image, OcrImage inputs [52] ); 
+//Segments the Words the Same Way, into Windows of the View
+int segment_letters(const OcrView &image, OcrView inputs [52] );
+//Rescales a Letter to a Square Glyph of the Given Size
+void rescale_glyph(OcrImage &image, int size);
+//Makes the Glyph of a Window of segment_letters, the Same as
+//segmentation and rescale_glyph on the Letter of segmentation_word
+void normalize_glyph(const OcrView &letter, int size, OcrImage &glyph);
 
 //Supplementary Code
 //Used for Comparison
 int compare (const void * a, const void * b);
+
+#endif
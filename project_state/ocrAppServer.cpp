@@ -0,0 +1,507 @@
+/***************************************************************
+ * Name:      ocrAppServer.cpp
+ * Purpose:   Code for the Socket Server of the Recognition Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppServer.h"
+#include "ocrImageIO.h"
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace std;
+
+//Functions
+bool read_line(int fd, string &buffer, string &line);
+bool read_bytes(int fd, string &buffer, size_t count, vector<char> &out);
+bool write_all(int fd, const string &text);
+
+ServerOptions::ServerOptions()
+{
+    port = 0;
+    workers = thread::hardware_concurrency();
+    if (workers < 1)
+        workers = 1;
+    queue_size = 64;
+    timeout_ms = 5000;
+    max_batch = 256;
+    max_bytes = 32 << 20;
+    max_clients = 64;
+}
+
+OcrServer::OcrServer(OcrEngine &engine, OcrPool &pool,
+    const ServerOptions &options)
+    : engine(engine), pool(pool), options(options), listener(-1),
+      stopping(false), clients(0), requests(0), writer(NULL), waiting(0),
+      active(0)
+{
+}
+
+OcrServer::~OcrServer()
+{
+    stop();
+    //Jobs still in the pool hold on to the server
+    {
+        unique_lock<mutex> guard(lock);
+        finished.wait(guard, [this]{ return active == 0; });
+    }
+    //Connections notice stop() within one receive timeout
+    while (clients > 0)
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    if (listener >= 0)
+        close(listener);
+    if (!options.socket_path.empty())
+        unlink(options.socket_path.c_str());
+}
+
+//Server Functions
+void OcrServer::set_writer(OcrWriter *writer)
+{
+    this->writer = writer;
+}
+
+bool OcrServer::start()
+{
+    //Unix Domain Socket
+    if (!options.socket_path.empty())
+    {
+        sockaddr_un address;
+        if (options.socket_path.size() >= sizeof(address.sun_path))
+        {
+            fprintf(stderr, "socket path is too long\n");
+            return false;
+        }
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, options.socket_path.c_str());
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(options.socket_path.c_str());
+        if (listener < 0 ||
+            bind(listener, (sockaddr *)&address, sizeof(address)) < 0)
+        {
+            perror("bind");
+            return false;
+        }
+    }
+    //TCP on the Loopback Interface Only
+    else
+    {
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(options.port);
+
+        int reuse = 1;
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener >= 0)
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse,
+                sizeof(reuse));
+        if (listener < 0 ||
+            bind(listener, (sockaddr *)&address, sizeof(address)) < 0)
+        {
+            perror("bind");
+            return false;
+        }
+    }
+
+    if (listen(listener, options.max_clients) < 0)
+    {
+        perror("listen");
+        return false;
+    }
+    return true;
+}
+
+void OcrServer::run()
+{
+    pollfd waiting;
+    waiting.fd = listener;
+    waiting.events = POLLIN;
+
+    //The poll timeout lets the loop notice stop() without a wakeup
+    while (!stopping)
+    {
+        if (poll(&waiting, 1, 200) <= 0)
+            continue;
+        int client = accept(listener, NULL, NULL);
+        if (client < 0)
+            continue;
+
+        if (clients >= options.max_clients)
+        {
+            write_all(client, "{\"error\":\"busy\"}\n");
+            close(client);
+            continue;
+        }
+        clients++;
+        thread(&OcrServer::serve, this, client).detach();
+    }
+}
+
+void OcrServer::stop()
+{
+    stopping = true;
+}
+
+/*
+* Each connection has its own thread that only parses requests and waits
+* for their answers. The recognition itself is done by the pool, so the
+* number of threads recognizing plates stays at the size of the pool no
+* matter how many clients are connected.
+*/
+void OcrServer::serve(int client)
+{
+    //Idle Connections are Dropped after the Timeout
+    timeval idle;
+    idle.tv_sec = options.timeout_ms / 1000;
+    idle.tv_usec = (options.timeout_ms % 1000) * 1000;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof(idle));
+
+    string buffer;
+    string line;
+    while (!stopping && read_line(client, buffer, line))
+    {
+        if (line == "PING")
+        {
+            if (!write_all(client, "{\"status\":\"ok\"}\n"))
+                break;
+            continue;
+        }
+        if (line == "MEMORY")
+        {
+            stringstream json;
+            json << "{\"peak_rss_kb\":" << peak_memory_kb()
+                 << ",\"bank_bytes\":" << engine.bank_bytes() << "}\n";
+            if (!write_all(client, json.str()))
+                break;
+            continue;
+        }
+
+        //Reading of the Request
+        int count = 0;
+        bool valid;
+        shared_ptr<Job> job(new Job);
+        if (line.compare(0, 6, "LEARN ") == 0)
+        {
+            job->confirmed = line.substr(6);
+            count = 1;
+            valid = !job->confirmed.empty() &&
+                job->confirmed.size() <= MAX_LETTERS;
+        }
+        else
+        {
+            valid = sscanf(line.c_str(), "RECOGNIZE %d", &count) == 1 &&
+                count > 0 && count <= options.max_batch;
+        }
+        for (int i = 0; valid && i < count; i++)
+        {
+            Item item;
+            long bytes = 0;
+            if (!read_line(client, buffer, line))
+                valid = false;
+            else if (line.compare(0, 5, "PATH ") == 0)
+                item.path = line.substr(5);
+            else if (sscanf(line.c_str(), "DATA %ld", &bytes) == 1 &&
+                bytes > 0 && bytes <= options.max_bytes)
+                valid = read_bytes(client, buffer, bytes, item.data);
+            else
+                valid = false;
+            job->items.push_back(item);
+        }
+        if (!valid)
+        {
+            //The rest of the stream cannot be trusted after a bad request
+            write_all(client, "{\"error\":\"bad request\"}\n");
+            break;
+        }
+
+        //Admission and Waiting
+        job->id = ++requests;
+        job->done = false;
+        job->cancelled = false;
+        job->deadline = chrono::steady_clock::now() +
+            chrono::milliseconds(options.timeout_ms);
+        string response;
+        if (!submit(job))
+        {
+            response = "{\"error\":\"busy\"}";
+        }
+        else
+        {
+            unique_lock<mutex> guard(lock);
+            if (finished.wait_until(guard, job->deadline,
+                [&job]{ return job->done; }))
+            {
+                response = job->response;
+            }
+            else
+            {
+                job->cancelled = true;
+                response = "{\"error\":\"timeout\"}";
+            }
+        }
+        if (!write_all(client, response + "\n"))
+            break;
+    }
+    close(client);
+    clients--;
+}
+
+/*
+* A job waits in the shared queue of the pool until a worker is free.
+* The admission limit counts the jobs that have not started yet.
+*/
+bool OcrServer::submit(const shared_ptr<Job> &job)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        if (waiting >= options.queue_size)
+            return false;
+        waiting++;
+        active++;
+    }
+    pool.submit([this, job]{ execute(job); });
+    return true;
+}
+
+void OcrServer::execute(const shared_ptr<Job> &job)
+{
+    bool skip;
+    {
+        lock_guard<mutex> guard(lock);
+        waiting--;
+        skip = job->cancelled || stopping;
+    }
+
+    string response;
+    if (!skip)
+        response = process(*job);
+
+    lock_guard<mutex> guard(lock);
+    job->response = response;
+    job->done = true;
+    active--;
+    finished.notify_all();
+}
+
+/*
+* All images of a request are loaded first and then recognized as one
+* batch, so their letters are scored against the templates together. A
+* compact engine is given them one at a time instead, so a single frame
+* is decoded at any time.
+*/
+string OcrServer::process(Job &job)
+{
+    if (!job.confirmed.empty())
+        return learn(job);
+
+    vector<int> loaded(job.items.size()); //Index in results, -1 if not
+    vector<bool> late(job.items.size());
+    vector<PlateResult> results;
+    if (engine.compact_enabled())
+    {
+        //Loading of Every Image as it is Recognized
+        results.resize(job.items.size());
+        engine.recognize_stream(job.items.size(), [&](int i, OcrImage &image)
+        {
+            loaded[i] = -1;
+            late[i] = chrono::steady_clock::now() > job.deadline;
+            if (late[i] || !load(job.items[i], image))
+                return false;
+            loaded[i] = i;
+            return true;
+        }, &results[0]);
+    }
+    else
+    {
+        //Loading of the Images
+        vector<OcrImage> images;
+        for (size_t i = 0; i < job.items.size(); i++)
+        {
+            loaded[i] = -1;
+            late[i] = chrono::steady_clock::now() > job.deadline;
+            if (late[i])
+                continue;
+
+            OcrImage image;
+            if (load(job.items[i], image))
+            {
+                loaded[i] = images.size();
+                images.push_back(image);
+            }
+        }
+
+        //Recognition of the Whole Batch
+        results.resize(images.size());
+        if (!images.empty())
+            engine.recognize_batch(&images[0], images.size(), &results[0]);
+    }
+
+    //The Log is Written by its Own Thread, this Only Queues
+    for (size_t i = 0; writer != NULL && i < job.items.size(); i++)
+    {
+        if (loaded[i] < 0)
+            continue;
+        stringstream source;
+        if (job.items[i].path.empty())
+            source << "request " << job.id << " image " << i;
+        else
+            source << job.items[i].path;
+        OcrRecord record;
+        make_record(engine, source.str(), results[loaded[i]], record);
+        writer->write(record);
+    }
+
+    stringstream json;
+    json << "{\"results\":[";
+    for (size_t i = 0; i < job.items.size(); i++)
+    {
+        if (i > 0)
+            json << ",";
+        if (late[i])
+            json << "{\"error\":\"timeout\"}";
+        else if (loaded[i] < 0)
+            json << "{\"error\":\"cannot load image\"}";
+        else
+            json << result_json(results[loaded[i]]);
+    }
+    json << "]}";
+    return json.str();
+}
+
+/*
+* The image is recognized as usual, and the letters it read wrong become
+* samples of the confirmed characters. The new templates are used by the
+* recognitions that start afterwards; those running keep theirs.
+*/
+string OcrServer::learn(Job &job)
+{
+    OcrImage image;
+    if (chrono::steady_clock::now() > job.deadline)
+        return "{\"error\":\"timeout\"}";
+    if (!load(job.items[0], image))
+        return "{\"error\":\"cannot load image\"}";
+
+    OcrImage letters[MAX_LETTERS];
+    PlateResult result;
+    int num_letters = engine.segment(image, letters, result.timings);
+    engine.identify(letters, num_letters, result);
+    int learned = engine.learn(letters, result, job.confirmed);
+    if (learned < 0)
+        return "{\"error\":\"letters do not match\"}";
+
+    stringstream json;
+    json << "{\"learned\":" << learned << "}";
+    return json.str();
+}
+
+bool OcrServer::load(const Item &item, OcrImage &image) const
+{
+    if (item.data.empty())
+        return load_image(item.path, image);
+    return load_image_memory((const unsigned char *)&item.data[0],
+        item.data.size(), image);
+}
+
+string OcrServer::result_json(const PlateResult &result) const
+{
+    stringstream json;
+    json << "{\"plate\":" << json_string(result.word)
+         << ",\"confidence\":" << result.confidence
+         << ",\"letters\":[";
+    for (int i = 0; i < result.num_letters; i++)
+    {
+        const CharResult &letter = result.chars[i];
+        if (i > 0)
+            json << ",";
+        json << "{\"char\":" << json_string(result.word.substr(i, 1))
+             << ",\"confidence\":" << letter.confidence
+             << ",\"candidates\":[";
+        for (int k = 0; k < letter.count; k++)
+        {
+            if (k > 0)
+                json << ",";
+            json << "{\"char\":"
+                 << json_string(string(1,
+                    engine.converter(letter.top[k].index)))
+                 << ",\"score\":" << letter.top[k].norm << "}";
+        }
+        json << "]}";
+    }
+    json << "]";
+    if (result.rejected != GATE_PASSED)
+        json << ",\"rejected\":\"" << gate_names[result.rejected] << "\"";
+    json << "}";
+    return json.str();
+}
+
+//Supplementary Code
+bool read_line(int fd, string &buffer, string &line)
+{
+    size_t end;
+    while ((end = buffer.find('\n')) == string::npos)
+    {
+        //Lines are commands, so anything long is not a valid request
+        if (buffer.size() > 4096)
+            return false;
+        char chunk[4096];
+        ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+        if (got <= 0)
+            return false;
+        buffer.append(chunk, got);
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    if (!line.empty() && line[line.size()-1] == '\r')
+        line.erase(line.size()-1);
+    return true;
+}
+
+bool read_bytes(int fd, string &buffer, size_t count, vector<char> &out)
+{
+    out.assign(buffer.begin(),
+        buffer.begin() + (buffer.size() < count ? buffer.size() : count));
+    buffer.erase(0, out.size());
+    while (out.size() < count)
+    {
+        char chunk[65536];
+        size_t want = count - out.size();
+        ssize_t got = recv(fd, chunk,
+            want < sizeof(chunk) ? want : sizeof(chunk), 0);
+        if (got <= 0)
+            return false;
+        out.insert(out.end(), chunk, chunk + got);
+    }
+    return true;
+}
+
+bool write_all(int fd, const string &text)
+{
+    size_t sent = 0;
+    while (sent < text.size())
+    {
+        ssize_t put = send(fd, text.data() + sent, text.size() - sent,
+            MSG_NOSIGNAL);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            return false;
+        sent += put;
+    }
+    return true;
+}
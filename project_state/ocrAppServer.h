@@ -0,0 +1,133 @@
+/***************************************************************
+ * Name:      ocrAppServer.h
+ * Purpose:   Defines the Socket Server of the Recognition Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPSERVER_H
+#define OCRAPPSERVER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "ocrAppEngine.h"
+#include "ocrAppWriter.h"
+
+using namespace std;
+
+/*
+* Protocol
+* A client sends any number of requests over one connection. Every
+* request is answered with a single line of JSON.
+*
+*   PING\n                    answered with {"status":"ok"}
+*   MEMORY\n                  answered with the peak memory of the daemon
+*                             and the size of its templates,
+*                             {"peak_rss_kb":51200,"bank_bytes":97344}
+*   RECOGNIZE <n>\n           followed by n images, each one either
+*     PATH <path>\n           an image file readable by the daemon
+*     DATA <bytes>\n<bytes>   the raw contents of an image file
+*   LEARN <plate>\n           followed by one image, as above, whose
+*                             reading an operator confirmed as plate
+*
+* A RECOGNIZE request is answered with one result per image
+*   {"results":[{"plate":"ABC1234","confidence":0.82,"letters":[...]},
+*               {"error":"cannot load image"}]}
+* or, for the whole request, {"error":"busy"} when the admission queue
+* is full, {"error":"timeout"} when it was not done in time and
+* {"error":"bad request"} when it could not be read. With the quality
+* gate of the engine on, an image it turns down is answered with an
+* empty plate and the reason, {"plate":"",...,"rejected":"blurred"}.
+*
+* A LEARN request is answered with {"learned":<n>}, the letters it read
+* wrong and added to the templates (see OcrEngine::learn), or with
+* {"error":"letters do not match"} when it does not find as many letters
+* as the plate has. Recognitions running meanwhile are not held up.
+*/
+
+//Settings of the Daemon
+struct ServerOptions
+{
+    string socket_path;  //Unix domain socket, TCP is used if empty
+    int port;            //Port on 127.0.0.1 for TCP
+    int workers;         //Number of recognition threads (of the pool)
+    int queue_size;      //Requests waiting for a worker before "busy"
+    int timeout_ms;      //Time a request may take, queueing included
+    int max_batch;       //Images in a single request
+    int max_bytes;       //Size of a single DATA image
+    int max_clients;     //Connections served at the same time
+
+    ServerOptions();
+};
+
+class OcrServer
+{
+public:
+    //The requests are run as tasks of the pool, which should be the
+    //pool of the engine too
+    OcrServer(OcrEngine &engine, OcrPool &pool,
+        const ServerOptions &options);
+    ~OcrServer();
+
+    //Logs every reading to the writer (not owned), none if NULL
+    void set_writer(OcrWriter *writer);
+    //Binds the socket
+    bool start();
+    //Accepts clients until stop() is called
+    void run();
+    //Safe to call from a signal handler
+    void stop();
+
+private:
+    //Image of a request
+    struct Item
+    {
+        string path;          //Set for PATH images
+        vector<char> data;    //Set for DATA images
+    };
+
+    //A request waiting for or being processed by the pool
+    struct Job
+    {
+        long id;              //Number of the request, for the log
+        vector<Item> items;
+        string confirmed;     //Plate of a LEARN request, empty otherwise
+        chrono::steady_clock::time_point deadline;
+        string response;
+        bool done;
+        bool cancelled;
+    };
+
+    //Server Functions
+    void serve(int client);
+    bool submit(const shared_ptr<Job> &job);
+    void execute(const shared_ptr<Job> &job);
+    string process(Job &job);
+    string learn(Job &job);
+    bool load(const Item &item, OcrImage &image) const;
+    string result_json(const PlateResult &result) const;
+
+    //Variables
+    OcrEngine &engine;
+    OcrPool &pool;
+    ServerOptions options;
+    int listener;
+    atomic<bool> stopping;
+    atomic<int> clients;
+    atomic<long> requests;        //Requests admitted so far
+    OcrWriter *writer;
+
+    mutex lock;
+    condition_variable finished;  //Signals a job that is done
+    int waiting;                  //Jobs submitted but not started
+    int active;                   //Jobs submitted but not finished
+};
+
+#endif
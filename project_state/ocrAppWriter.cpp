@@ -0,0 +1,451 @@
+/***************************************************************
+ * Name:      ocrAppWriter.cpp
+ * Purpose:   Code for the Result Log written by the GUI, the
+ *            Command Line Tools and the Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrAppWriter.h"
+#include <sstream>
+#include <string.h>
+#include <chrono>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*
+* Binary Log
+* The file starts with the 8 bytes "OCRLOG01". Every record follows as
+*
+*   u32  size of the rest of the record
+*   i64  timestamp
+*   u16  length of the source, then its bytes
+*   u8   length of the plate, then its bytes
+*   f32  confidence
+*   u8   number of letters, then for every letter
+*          u8   number of candidates, then for every candidate
+*                 u8   character
+*                 u16  score times 65535
+*   u8   number of stages, then f32 microseconds for every stage
+*
+* with every number little-endian. A reader can skip records it does not
+* understand by their size.
+*/
+
+//Functions
+void put_bytes(string &out, uint64_t value, int bytes);
+void put_float(string &out, float value);
+void binary_record(const OcrRecord &record, string &out);
+bool parse_record(const unsigned char *data, size_t size, OcrRecord &record);
+
+//Definitions
+#define LOG_MAGIC "OCRLOG01"
+#define LOG_MAGIC_SIZE 8
+#define MAX_QUEUE 65536 //Records waiting before write() drops
+
+OcrWriter::OcrWriter()
+{
+    jsonl = NULL;
+    binary = NULL;
+    commit_ms = 50;
+    commit_records = 256;
+    max_queue = MAX_QUEUE;
+    sync = false;
+    stopping = false;
+    flushers = 0;
+    queued_total = 0;
+    written_total = 0;
+    dropped_total = 0;
+}
+
+OcrWriter::~OcrWriter()
+{
+    close();
+}
+
+bool OcrWriter::open(const string &jsonl, const string &binary,
+    int commit_ms, int commit_records, bool sync)
+{
+    close();
+    if (!jsonl.empty())
+    {
+        this->jsonl = fopen(jsonl.c_str(), "ab");
+        if (this->jsonl == NULL)
+            return false;
+    }
+    if (!binary.empty())
+    {
+        this->binary = fopen(binary.c_str(), "ab");
+        if (this->binary == NULL)
+        {
+            close();
+            return false;
+        }
+        //A New Log Starts with its Magic
+        fseek(this->binary, 0, SEEK_END);
+        if (ftell(this->binary) == 0)
+        {
+            fwrite(LOG_MAGIC, 1, LOG_MAGIC_SIZE, this->binary);
+            fflush(this->binary);
+        }
+    }
+    this->commit_ms = (commit_ms > 0) ? commit_ms : 1;
+    this->commit_records = (commit_records > 0) ? commit_records : 1;
+    this->sync = sync;
+    stopping = false;
+    writer = thread(&OcrWriter::run, this);
+    return true;
+}
+
+void OcrWriter::close()
+{
+    if (writer.joinable())
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        writer.join();
+    }
+    if (jsonl != NULL)
+        fclose(jsonl);
+    if (binary != NULL)
+        fclose(binary);
+    jsonl = NULL;
+    binary = NULL;
+}
+
+bool OcrWriter::is_open() const
+{
+    return jsonl != NULL || binary != NULL;
+}
+
+bool OcrWriter::write(const OcrRecord &record)
+{
+    bool first;
+    {
+        lock_guard<mutex> guard(lock);
+        if (!writer.joinable() || stopping)
+            return false;
+        if (queue.size() >= max_queue)
+        {
+            dropped_total++;
+            return false;
+        }
+        first = queue.empty();
+        queue.push_back(record);
+        queued_total++;
+        //The Writer is Woken for a New Group and for a Full One
+        if (!first && queue.size() < commit_records)
+            return true;
+    }
+    wakeup.notify_one();
+    return true;
+}
+
+void OcrWriter::flush()
+{
+    unique_lock<mutex> guard(lock);
+    long target = queued_total;
+    flushers++;
+    wakeup.notify_one();
+    committed.wait(guard, [&]{ return written_total >= target; });
+    flushers--;
+}
+
+long OcrWriter::written() const
+{
+    lock_guard<mutex> guard(lock);
+    return written_total;
+}
+
+long OcrWriter::dropped() const
+{
+    lock_guard<mutex> guard(lock);
+    return dropped_total;
+}
+
+//Writer Functions
+void OcrWriter::run()
+{
+    unique_lock<mutex> guard(lock);
+    while (true)
+    {
+        wakeup.wait(guard, [this]{ return stopping || !queue.empty(); });
+        if (queue.empty())
+            return;
+
+        //A Group Fills until it is Large Enough or its First Record is Due
+        wakeup.wait_for(guard, chrono::milliseconds(commit_ms), [this]
+        {
+            return stopping || flushers > 0 ||
+                queue.size() >= commit_records;
+        });
+
+        vector<OcrRecord> group;
+        group.swap(queue);
+        guard.unlock();
+        commit(group);
+        guard.lock();
+        written_total += group.size();
+        committed.notify_all();
+    }
+}
+
+//One write per file for the whole group
+void OcrWriter::commit(const vector<OcrRecord> &group)
+{
+    if (jsonl != NULL)
+    {
+        string out;
+        for (size_t i = 0; i < group.size(); i++)
+            out += record_json(group[i]) + "\n";
+        fwrite(out.data(), 1, out.size(), jsonl);
+        fflush(jsonl);
+    }
+    if (binary != NULL)
+    {
+        string out;
+        for (size_t i = 0; i < group.size(); i++)
+            binary_record(group[i], out);
+        fwrite(out.data(), 1, out.size(), binary);
+        fflush(binary);
+    }
+#ifndef _WIN32
+    if (sync)
+    {
+        if (jsonl != NULL)
+            fsync(fileno(jsonl));
+        if (binary != NULL)
+            fsync(fileno(binary));
+    }
+#endif
+}
+
+//Record Functions
+void make_record(const OcrEngine &engine, const string &source,
+    const PlateResult &result, OcrRecord &record)
+{
+    record.source = source;
+    record.timestamp = chrono::duration_cast<chrono::microseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+    record.plate = result.word;
+    record.confidence = result.confidence;
+    record.num_letters = result.num_letters;
+    for (int i = 0; i < result.num_letters; i++)
+    {
+        const CharResult &letter = result.chars[i];
+        record.counts[i] = letter.count;
+        for (int k = 0; k < letter.count; k++)
+        {
+            record.letters[i][k] = engine.converter(letter.top[k].index);
+            record.scores[i][k] = letter.top[k].norm;
+        }
+    }
+    for (int s = 0; s < NUM_STAGES; s++)
+        record.timings[s] = result.timings[s];
+}
+
+string record_json(const OcrRecord &record)
+{
+    stringstream json;
+    json << "{\"source\":" << json_string(record.source)
+         << ",\"time\":" << record.timestamp
+         << ",\"plate\":" << json_string(record.plate)
+         << ",\"confidence\":" << record.confidence
+         << ",\"letters\":[";
+    for (int i = 0; i < record.num_letters; i++)
+    {
+        if (i > 0)
+            json << ",";
+        json << "[";
+        for (int k = 0; k < record.counts[i]; k++)
+        {
+            if (k > 0)
+                json << ",";
+            json << "{\"char\":"
+                 << json_string(string(1, record.letters[i][k]))
+                 << ",\"score\":" << record.scores[i][k] << "}";
+        }
+        json << "]";
+    }
+    json << "],\"timings\":{";
+    for (int s = 0; s < NUM_STAGES; s++)
+    {
+        if (s > 0)
+            json << ",";
+        json << "\"" << stage_names[s] << "\":" << record.timings[s];
+    }
+    json << "}}";
+    return json.str();
+}
+
+bool read_log(const string &filename, vector<OcrRecord> &records)
+{
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL)
+        return false;
+    string data;
+    char chunk[65536];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.append(chunk, got);
+    fclose(file);
+
+    if (data.size() < LOG_MAGIC_SIZE ||
+        memcmp(data.data(), LOG_MAGIC, LOG_MAGIC_SIZE) != 0)
+        return false;
+
+    //A Record Cut Short Ends the Log
+    const unsigned char *bytes = (const unsigned char *)data.data();
+    size_t at = LOG_MAGIC_SIZE;
+    while (at < data.size())
+    {
+        if (data.size() - at < 4)
+            return false;
+        size_t size = bytes[at] | bytes[at + 1] << 8 |
+            bytes[at + 2] << 16 | (size_t)bytes[at + 3] << 24;
+        at += 4;
+        if (data.size() - at < size)
+            return false;
+        OcrRecord record;
+        if (!parse_record(bytes + at, size, record))
+            return false;
+        records.push_back(record);
+        at += size;
+    }
+    return true;
+}
+
+//Supplementary Code
+string json_string(const string &text)
+{
+    string quoted = "\"";
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        char c = text[i];
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char escaped[8];
+            sprintf(escaped, "\\u%04x", c);
+            quoted += escaped;
+        }
+        else
+            quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void put_bytes(string &out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out += (char)(value >> (8 * i));
+}
+
+void put_float(string &out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    put_bytes(out, bits, 4);
+}
+
+void binary_record(const OcrRecord &record, string &out)
+{
+    string body;
+    size_t source = record.source.size() < 65535 ? record.source.size() : 65535;
+    size_t plate = record.plate.size() < 255 ? record.plate.size() : 255;
+    put_bytes(body, record.timestamp, 8);
+    put_bytes(body, source, 2);
+    body.append(record.source, 0, source);
+    put_bytes(body, plate, 1);
+    body.append(record.plate, 0, plate);
+    put_float(body, record.confidence);
+    put_bytes(body, record.num_letters, 1);
+    for (int i = 0; i < record.num_letters; i++)
+    {
+        put_bytes(body, record.counts[i], 1);
+        for (int k = 0; k < record.counts[i]; k++)
+        {
+            put_bytes(body, (unsigned char)record.letters[i][k], 1);
+            put_bytes(body, (int)(record.scores[i][k] * 65535 + 0.5), 2);
+        }
+    }
+    put_bytes(body, NUM_STAGES, 1);
+    for (int s = 0; s < NUM_STAGES; s++)
+        put_float(body, record.timings[s]);
+
+    put_bytes(out, body.size(), 4);
+    out += body;
+}
+
+//Reads the fields of binary_record, checking every length
+bool parse_record(const unsigned char *data, size_t size, OcrRecord &record)
+{
+    size_t at = 0;
+    #define NEED(n) if (size - at < (size_t)(n)) return false
+    #define GET(n, value) \
+        do { NEED(n); uint64_t v = 0; \
+            for (int b = 0; b < (n); b++) v |= (uint64_t)data[at + b] << (8 * b); \
+            at += (n); value = v; } while (0)
+
+    uint64_t value;
+    uint32_t bits;
+    float number;
+    GET(8, value);
+    record.timestamp = value;
+    GET(2, value);
+    NEED(value);
+    record.source.assign((const char *)data + at, value);
+    at += value;
+    GET(1, value);
+    NEED(value);
+    record.plate.assign((const char *)data + at, value);
+    at += value;
+    GET(4, bits);
+    memcpy(&number, &bits, 4);
+    record.confidence = number;
+    GET(1, value);
+    if (value > MAX_LETTERS)
+        return false;
+    record.num_letters = value;
+    for (int i = 0; i < record.num_letters; i++)
+    {
+        GET(1, value);
+        if (value > TOP_K)
+            return false;
+        record.counts[i] = value;
+        for (int k = 0; k < record.counts[i]; k++)
+        {
+            GET(1, value);
+            record.letters[i][k] = value;
+            GET(2, value);
+            record.scores[i][k] = value / 65535.0f;
+        }
+    }
+    GET(1, value);
+    int stages = value;
+    for (int s = 0; s < stages; s++)
+    {
+        GET(4, bits);
+        memcpy(&number, &bits, 4);
+        //Stages of a later version are skipped
+        if (s < NUM_STAGES)
+            record.timings[s] = number;
+    }
+    for (int s = stages; s < NUM_STAGES; s++)
+        record.timings[s] = 0;
+    return true;
+
+    #undef GET
+    #undef NEED
+}
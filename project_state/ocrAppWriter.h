@@ -0,0 +1,104 @@
+/***************************************************************
+ * Name:      ocrAppWriter.h
+ * Purpose:   Defines the Result Log written by the GUI, the
+ *            Command Line Tools and the Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRAPPWRITER_H
+#define OCRAPPWRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ocrAppEngine.h"
+
+using namespace std;
+
+//A Reading as it is Logged
+struct OcrRecord
+{
+    string source;        //File, request or frame the plate came from
+    int64_t timestamp;    //Microseconds since the epoch
+    string plate;         //Interpretation
+    double confidence;    //Confidence of the Whole Word
+    int num_letters;
+    int counts[MAX_LETTERS];              //Candidates per Letter
+    char letters[MAX_LETTERS][TOP_K];     //Candidates, Best First
+    float scores[MAX_LETTERS][TOP_K];     //Their Scores (0 to 1)
+    double timings[NUM_STAGES];           //Microseconds per Stage
+};
+
+/*
+* An append-only log of readings, as JSON Lines, as a compact binary log
+* (laid out in ocrAppWriter.cpp) or both. write() only queues the record;
+* a single writer thread takes everything queued at once and writes it
+* with one call per file, as soon as commit_records are waiting or the
+* oldest has waited commit_ms. Recognition threads never wait for the
+* disk: when the queue is full, write() drops the record and says so.
+*/
+class OcrWriter
+{
+public:
+    OcrWriter();
+    //Writes everything still queued
+    ~OcrWriter();
+
+    //Either path may be empty. The files are appended to. With sync,
+    //every group is also flushed to the disk, not just to the system
+    bool open(const string &jsonl, const string &binary,
+        int commit_ms = 50, int commit_records = 256, bool sync = false);
+    void close();
+    bool is_open() const;
+
+    //Queues a record, false if the queue was full and it was dropped
+    bool write(const OcrRecord &record);
+    //Returns once everything queued so far is written
+    void flush();
+
+    long written() const;
+    long dropped() const;
+
+private:
+    //Writer Functions
+    void run();
+    void commit(const vector<OcrRecord> &group);
+
+    //Variables
+    FILE *jsonl;
+    FILE *binary;
+    int commit_ms;
+    size_t commit_records;
+    size_t max_queue;       //Records queued before write() drops
+    bool sync;
+    thread writer;
+    mutable mutex lock;
+    condition_variable wakeup;     //Signals the writer
+    condition_variable committed;  //Signals a group that is written
+    vector<OcrRecord> queue;
+    bool stopping;
+    int flushers;           //Threads waiting in flush()
+    long queued_total;      //Records accepted by write()
+    long written_total;     //Records written to the files
+    long dropped_total;     //Records dropped by write()
+};
+
+//Record Functions
+//Fills a record with a reading, stamped with the current time
+void make_record(const OcrEngine &engine, const string &source,
+    const PlateResult &result, OcrRecord &record);
+string record_json(const OcrRecord &record);
+//Reads back every record of a binary log
+bool read_log(const string &filename, vector<OcrRecord> &records);
+
+//Supplementary Code
+//Quotes and escapes a string for JSON
+string json_string(const string &text);
+
+#endif
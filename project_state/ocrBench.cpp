@@ -0,0 +1,242 @@
+/***************************************************************
+ * Name:      ocrBench.cpp
+ * Purpose:   Timing of Every Stage of the Recognition Pipeline
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include "ocrAppEngine.h"
+#include "ocrAppPrepro.h"
+#include "ocrImageIO.h"
+
+using namespace std;
+
+//Functions
+double elapsed_us(chrono::steady_clock::time_point start);
+void usage();
+
+/*
+* Runs every image through the same stages as OcrEngine::recognize and
+* prints the average time of each stage per image. It also serves as the
+* training run of a profile-guided build (OCR_PGO=GENERATE).
+*/
+int main(int argc, char **argv)
+{
+    string trainset = "trainset";
+    string matcher = "pixels";
+    int glyph = GLYPH_LARGE;
+    double margin = -1;
+    int skew = DESKEW_DEGREES;
+    string cleanup = "on";
+    string compact = "off";
+    string gate = "off";
+    int threads = 0;
+    int placement = PLACE_NONE;
+    int iterations = 20;
+    vector<string> files;
+
+    //Command Line Options
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            files.push_back(arg);
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            usage();
+            return 1;
+        }
+        if (arg == "--trainset")
+            trainset = argv[++i];
+        else if (arg == "--matcher")
+            matcher = argv[++i];
+        else if (arg == "--glyph")
+            glyph = atoi(argv[++i]);
+        else if (arg == "--pyramid")
+            margin = atof(argv[++i]);
+        else if (arg == "--deskew")
+            skew = atoi(argv[++i]);
+        else if (arg == "--cleanup")
+            cleanup = argv[++i];
+        else if (arg == "--compact")
+            compact = argv[++i];
+        else if (arg == "--gate")
+            gate = argv[++i];
+        else if (arg == "--threads")
+            threads = atoi(argv[++i]);
+        else if (arg == "--placement")
+        {
+            if (!parse_placement(argv[++i], placement))
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (arg == "--iterations")
+            iterations = atoi(argv[++i]);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (files.empty() || iterations < 1 ||
+        (matcher != "pixels" && matcher != "chamfer"))
+    {
+        usage();
+        return 1;
+    }
+
+    //One Thread Needs no Pool
+    unique_ptr<OcrPool> pool;
+    if (threads != 1)
+        pool.reset(new OcrPool(threads, placement));
+
+    OcrEngine engine;
+    engine.set_pool(pool.get());
+    if (!engine.train(trainset))
+    {
+        fprintf(stderr, "cannot load the training set from %s\n",
+            trainset.c_str());
+        return 1;
+    }
+    if (!engine.set_glyph_size(glyph) || !engine.set_deskew(skew) ||
+        (margin >= 0 && !engine.set_pyramid(PYRAMID_LEVELS, margin)) ||
+        (cleanup != "on" && cleanup != "off") ||
+        (compact != "on" && compact != "off") ||
+        (gate != "on" && gate != "off"))
+    {
+        usage();
+        return 1;
+    }
+    engine.set_cleanup(cleanup == "on");
+    engine.set_compact(compact == "on");
+    engine.set_gate(gate == "on");
+    if (matcher == "chamfer")
+        engine.set_matcher(MATCH_CHAMFER);
+
+    vector<OcrImage> images(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (!load_image(files[i], images[i]))
+        {
+            fprintf(stderr, "cannot load %s\n", files[i].c_str());
+            return 1;
+        }
+    }
+
+    //Stage Timings
+    double gray_us = 0, quality_us = 0, thr_us = 0, seg_us = 0, word_us = 0;
+    double match_us = 0;
+    long letters = 0;
+    long decided[PYRAMID_LEVELS] = {0};
+    for (int it = 0; it < iterations; it++)
+    {
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            OcrImage input = images[i].Copy();
+            OcrImage glyphs[MAX_LETTERS];
+            PlateResult result;
+
+            //The Gate's Measure, on the Color Frame
+            FrameQuality quality;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            frame_quality(input, quality);
+            quality_us += elapsed_us(start);
+
+            start = chrono::steady_clock::now();
+            color_plane(input, pool.get());
+            gray_us += elapsed_us(start);
+
+            start = chrono::steady_clock::now();
+            threshold(input, 0, pool.get());
+            thr_us += elapsed_us(start);
+
+            start = chrono::steady_clock::now();
+            OcrView plate = engine.find_plate(input);
+            seg_us += elapsed_us(start);
+
+            start = chrono::steady_clock::now();
+            OcrView windows[MAX_LETTERS];
+            int num_letters = segment_letters(plate, windows);
+            for (int a = 0; a < num_letters; a++)
+                normalize_glyph(windows[a], engine.glyph_size(), glyphs[a]);
+            word_us += elapsed_us(start);
+
+            start = chrono::steady_clock::now();
+            engine.identify(glyphs, num_letters, result);
+            match_us += elapsed_us(start);
+            letters += num_letters;
+            for (int a = 0; a < num_letters; a++)
+                decided[result.chars[a].level]++;
+        }
+    }
+
+    //Whole Batches
+    vector<PlateResult> results(images.size());
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++)
+    {
+        engine.recognize_batch(&images[0], images.size(), &results[0]);
+    }
+    double batch_us = elapsed_us(start);
+    int skipped = 0;
+    for (size_t i = 0; i < results.size(); i++)
+        skipped += results[i].rejected != GATE_PASSED;
+
+    double runs = (double)iterations * images.size();
+    printf("images            %d x %d\n", (int)images.size(), iterations);
+    printf("matcher           %s (%s kernel)\n", matcher.c_str(),
+        batch_kernel_name());
+    printf("glyph             %d x %d\n", engine.glyph_size(),
+        engine.glyph_size());
+    printf("threads           %d\n", pool ? pool->size() : 1);
+    printf("color_plane       %10.1f us/image\n", gray_us / runs);
+    printf("frame_quality     %10.1f us/image\n", quality_us / runs);
+    printf("threshold         %10.1f us/image\n", thr_us / runs);
+    printf("segmentation      %10.1f us/image\n", seg_us / runs);
+    printf("segmentation_word %10.1f us/image\n", word_us / runs);
+    printf("identify          %10.1f us/image, %.2f us/letter\n",
+        match_us / runs, letters ? match_us / letters : 0.0);
+    printf("recognize_batch   %10.1f us/image\n", batch_us / runs);
+    if (engine.gate_enabled())
+        printf("skipped           %10d of %d images\n", skipped,
+            (int)images.size());
+    printf("bank              %10.1f KB%s\n", engine.bank_bytes() / 1024.0,
+        engine.compact_enabled() ? " (compact)" : "");
+    printf("peak memory       %10ld KB\n", peak_memory_kb());
+    for (int l = PYRAMID_LEVELS - 1; l >= 0; l--)
+    {
+        printf("decided at %3d    %10.1f %%\n",
+            PYRAMID_SIZE(engine.glyph_size(), l),
+            letters ? 100.0 * decided[l] / letters : 0.0);
+    }
+    return 0;
+}
+
+double elapsed_us(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, micro>(
+        chrono::steady_clock::now() - start).count();
+}
+
+void usage()
+{
+    fprintf(stderr,
+        "usage: ocrBench [--trainset <dir>] [--matcher pixels|chamfer]\n"
+        "                [--glyph <size>] [--pyramid <margin>]\n"
+        "                [--deskew <degrees>] [--cleanup on|off]\n"
+        "                [--compact on|off] [--gate on|off]\n"
+        "                [--threads <n>] [--placement none|cores|numa]\n"
+        "                [--iterations <n>] <image>...\n");
+}
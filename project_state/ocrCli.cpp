@@ -0,0 +1,255 @@
+/***************************************************************
+ * Name:      ocrCli.cpp
+ * Purpose:   Command Line Recognition of Image Files
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include "ocrAppEngine.h"
+#include "ocrImageIO.h"
+#include "ocrAppWriter.h"
+#include "ocrAppFusion.h"
+
+using namespace std;
+
+//Functions
+void usage();
+
+/*
+* Prints one line per image: the file, the plate and its confidence,
+* separated by tabs. All images are recognized as one batch, on all CPUs
+* unless --threads says otherwise. --jsonl and --log append every reading
+* with its scores and timings to a result log (see ocrAppWriter.h).
+* With --compact on the images are decoded one at a time as they are
+* recognized, and the peak memory of the process goes to stderr. With
+* --gate on, the frames the quality gate skips read nothing and are
+* named on stderr with the reason.
+*
+* With --track, the images are consecutive frames of one vehicle. They
+* are recognized one at a time, in order, and their readings fused (see
+* ocrAppFusion.h) until the consensus reaches the confidence given; the
+* frames left are not recognized. The fused reading follows the frames,
+* as "track", and the frames it took go to stderr.
+*/
+int main(int argc, char **argv)
+{
+    string trainset = "trainset";
+    string formats = "grammar.txt";
+    string matcher = "pixels";
+    int glyph = GLYPH_LARGE;
+    double margin = -1;
+    int skew = DESKEW_DEGREES;
+    string cleanup = "on";
+    string compact = "off";
+    string gate = "off";
+    double track = -1;
+    int threads = 0;
+    int placement = PLACE_NONE;
+    string jsonl, log;
+    vector<string> files;
+
+    //Command Line Options
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            files.push_back(arg);
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            usage();
+            return 1;
+        }
+        if (arg == "--trainset")
+            trainset = argv[++i];
+        else if (arg == "--grammar")
+            formats = argv[++i];
+        else if (arg == "--matcher")
+            matcher = argv[++i];
+        else if (arg == "--glyph")
+            glyph = atoi(argv[++i]);
+        else if (arg == "--pyramid")
+            margin = atof(argv[++i]);
+        else if (arg == "--deskew")
+            skew = atoi(argv[++i]);
+        else if (arg == "--cleanup")
+            cleanup = argv[++i];
+        else if (arg == "--compact")
+            compact = argv[++i];
+        else if (arg == "--gate")
+            gate = argv[++i];
+        else if (arg == "--track")
+            track = atof(argv[++i]);
+        else if (arg == "--jsonl")
+            jsonl = argv[++i];
+        else if (arg == "--log")
+            log = argv[++i];
+        else if (arg == "--threads")
+            threads = atoi(argv[++i]);
+        else if (arg == "--placement")
+        {
+            if (!parse_placement(argv[++i], placement))
+            {
+                usage();
+                return 1;
+            }
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (files.empty() || (matcher != "pixels" && matcher != "chamfer"))
+    {
+        usage();
+        return 1;
+    }
+
+    //One Thread Needs no Pool
+    unique_ptr<OcrPool> pool;
+    if (threads != 1)
+        pool.reset(new OcrPool(threads, placement));
+
+    OcrEngine engine;
+    engine.set_pool(pool.get());
+    if (!engine.train(trainset))
+    {
+        fprintf(stderr, "cannot load the training set from %s\n",
+            trainset.c_str());
+        return 1;
+    }
+    engine.load_formats(formats);
+    if (!engine.set_glyph_size(glyph) || !engine.set_deskew(skew) ||
+        (margin >= 0 && !engine.set_pyramid(PYRAMID_LEVELS, margin)) ||
+        (cleanup != "on" && cleanup != "off") ||
+        (compact != "on" && compact != "off") ||
+        (gate != "on" && gate != "off"))
+    {
+        usage();
+        return 1;
+    }
+    engine.set_cleanup(cleanup == "on");
+    engine.set_compact(compact == "on");
+    engine.set_gate(gate == "on");
+    if (matcher == "chamfer")
+        engine.set_matcher(MATCH_CHAMFER);
+
+    //Loading and Recognition, One Frame at a Time when Compact or Fused
+    int status = 0;
+    vector<string> names;
+    vector<PlateResult> results;
+    OcrTrack fusion(track);
+    if (track >= 0)
+    {
+        for (size_t i = 0; i < files.size() && !fusion.decided(); i++)
+        {
+            OcrImage image;
+            if (!load_image(files[i], image))
+            {
+                fprintf(stderr, "cannot load %s\n", files[i].c_str());
+                status = 1;
+                continue;
+            }
+            results.push_back(PlateResult());
+            engine.recognize(image, results.back());
+            names.push_back(files[i]);
+            fusion.add(results.back());
+        }
+    }
+    else if (engine.compact_enabled())
+    {
+        vector<PlateResult> all(files.size());
+        vector<bool> loaded(files.size());
+        engine.recognize_stream(files.size(), [&](int index, OcrImage &image)
+        {
+            loaded[index] = load_image(files[index], image);
+            return loaded[index];
+        }, &all[0]);
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            if (!loaded[i])
+            {
+                fprintf(stderr, "cannot load %s\n", files[i].c_str());
+                status = 1;
+                continue;
+            }
+            results.push_back(all[i]);
+            names.push_back(files[i]);
+        }
+    }
+    else
+    {
+        vector<OcrImage> images;
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            OcrImage image;
+            if (!load_image(files[i], image))
+            {
+                fprintf(stderr, "cannot load %s\n", files[i].c_str());
+                status = 1;
+                continue;
+            }
+            images.push_back(image);
+            names.push_back(files[i]);
+        }
+        results.resize(images.size());
+        if (!images.empty())
+            engine.recognize_batch(&images[0], images.size(), &results[0]);
+    }
+    if (results.empty())
+        return status;
+
+    OcrWriter writer;
+    if ((!jsonl.empty() || !log.empty()) && !writer.open(jsonl, log))
+    {
+        fprintf(stderr, "cannot open the result log\n");
+        return 1;
+    }
+
+    //Readings
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        printf("%s\t%s\t%.3f\n", names[i].c_str(), results[i].word.c_str(),
+            results[i].confidence);
+        if (results[i].rejected != GATE_PASSED)
+            fprintf(stderr, "%s skipped, %s\n", names[i].c_str(),
+                gate_names[results[i].rejected]);
+        if (writer.is_open())
+        {
+            OcrRecord record;
+            make_record(engine, names[i], results[i], record);
+            writer.write(record);
+        }
+    }
+    if (track >= 0)
+    {
+        printf("track\t%s\t%.3f\n", fusion.word().c_str(),
+            fusion.confidence());
+        fprintf(stderr, "fused %d of %d frames\n", fusion.frames(),
+            (int)files.size());
+    }
+    if (engine.compact_enabled())
+        fprintf(stderr, "peak memory %ld KB\n", peak_memory_kb());
+    return status;
+}
+
+void usage()
+{
+    fprintf(stderr,
+        "usage: ocrCli [--trainset <dir>] [--grammar <file>]\n"
+        "              [--matcher pixels|chamfer] [--glyph <size>]\n"
+        "              [--pyramid <margin>] [--deskew <degrees>]\n"
+        "              [--cleanup on|off] [--compact on|off]\n"
+        "              [--gate on|off] [--track <confidence>]\n"
+        "              [--threads <n>] [--placement none|cores|numa]\n"
+        "              [--jsonl <file>] [--log <file>] <image>...\n");
+}
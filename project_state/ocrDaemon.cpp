@@ -0,0 +1,182 @@
+/***************************************************************
+ * Name:      ocrDaemon.cpp
+ * Purpose:   Resident Recognition Service listening on a Local
+ *            Socket (see ocrAppServer.h for the protocol)
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ocrAppEngine.h"
+#include "ocrAppServer.h"
+
+using namespace std;
+
+//Functions
+void on_signal(int signal);
+void usage();
+
+OcrServer *running = NULL;
+
+int main(int argc, char **argv)
+{
+    ServerOptions options;
+    string trainset = "trainset";
+    string formats = "grammar.txt";
+    string matcher = "pixels";
+    int glyph = GLYPH_LARGE;
+    double margin = -1;
+    int skew = DESKEW_DEGREES;
+    string cleanup = "on";
+    string compact = "off";
+    string gate = "off";
+    int placement = PLACE_NONE;
+    string jsonl, log;
+
+    //Command Line Options
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 == argc)
+        {
+            usage();
+            return 1;
+        }
+        if (arg == "--socket")
+            options.socket_path = argv[++i];
+        else if (arg == "--port")
+            options.port = atoi(argv[++i]);
+        else if (arg == "--workers")
+            options.workers = atoi(argv[++i]);
+        else if (arg == "--placement")
+        {
+            if (!parse_placement(argv[++i], placement))
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (arg == "--jsonl")
+            jsonl = argv[++i];
+        else if (arg == "--log")
+            log = argv[++i];
+        else if (arg == "--queue")
+            options.queue_size = atoi(argv[++i]);
+        else if (arg == "--timeout")
+            options.timeout_ms = atoi(argv[++i]);
+        else if (arg == "--trainset")
+            trainset = argv[++i];
+        else if (arg == "--grammar")
+            formats = argv[++i];
+        else if (arg == "--matcher")
+            matcher = argv[++i];
+        else if (arg == "--glyph")
+            glyph = atoi(argv[++i]);
+        else if (arg == "--pyramid")
+            margin = atof(argv[++i]);
+        else if (arg == "--deskew")
+            skew = atoi(argv[++i]);
+        else if (arg == "--cleanup")
+            cleanup = argv[++i];
+        else if (arg == "--compact")
+            compact = argv[++i];
+        else if (arg == "--gate")
+            gate = argv[++i];
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (options.socket_path.empty() && options.port <= 0)
+    {
+        usage();
+        return 1;
+    }
+    if (matcher != "pixels" && matcher != "chamfer")
+    {
+        usage();
+        return 1;
+    }
+    if (options.workers < 1 || options.queue_size < 1 ||
+        options.timeout_ms < 1)
+    {
+        usage();
+        return 1;
+    }
+
+    //The Training Set is Loaded Once for All Requests
+    OcrEngine engine;
+    if (!engine.train(trainset))
+    {
+        fprintf(stderr, "cannot load the training set from %s\n",
+            trainset.c_str());
+        return 1;
+    }
+    engine.load_formats(formats);
+    if (!engine.set_glyph_size(glyph) || !engine.set_deskew(skew) ||
+        (margin >= 0 && !engine.set_pyramid(PYRAMID_LEVELS, margin)) ||
+        (cleanup != "on" && cleanup != "off") ||
+        (compact != "on" && compact != "off") ||
+        (gate != "on" && gate != "off"))
+    {
+        usage();
+        return 1;
+    }
+    engine.set_cleanup(cleanup == "on");
+    engine.set_compact(compact == "on");
+    engine.set_gate(gate == "on");
+    if (matcher == "chamfer")
+        engine.set_matcher(MATCH_CHAMFER);
+
+    //Requests, plates and letters all Share the Same Threads
+    OcrPool pool(options.workers, placement);
+    engine.set_pool(&pool);
+
+    //Readings are Logged by a Thread of their Own
+    OcrWriter writer;
+    if ((!jsonl.empty() || !log.empty()) && !writer.open(jsonl, log))
+    {
+        fprintf(stderr, "cannot open the result log\n");
+        return 1;
+    }
+
+    OcrServer server(engine, pool, options);
+    if (writer.is_open())
+        server.set_writer(&writer);
+    if (!server.start())
+        return 1;
+    running = &server;
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "ready with %d workers\n", options.workers);
+    server.run();
+    running = NULL;
+    return 0;
+}
+
+void on_signal(int)
+{
+    if (running != NULL)
+        running->stop();
+}
+
+void usage()
+{
+    fprintf(stderr,
+        "usage: ocrDaemon (--socket <path> | --port <port>)\n"
+        "                 [--workers <n>] [--placement none|cores|numa]\n"
+        "                 [--queue <n>] [--timeout <ms>]\n"
+        "                 [--trainset <dir>] [--grammar <file>]\n"
+        "                 [--matcher pixels|chamfer] [--glyph <size>]\n"
+        "                 [--pyramid <margin>] [--deskew <degrees>]\n"
+        "                 [--cleanup on|off] [--compact on|off]\n"
+        "                 [--gate on|off]\n"
+        "                 [--jsonl <file>] [--log <file>]\n");
+}
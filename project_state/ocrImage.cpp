@@ -0,0 +1,128 @@
+/***************************************************************
+ * Name:      ocrImage.cpp
+ * Purpose:   Code for the RGB Image used by the Recognition Core
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrImage.h"
+#include <string.h>
+
+OcrImage::OcrImage()
+    : width(0), height(0)
+{
+}
+
+OcrImage::OcrImage(int width, int height)
+    : width(0), height(0)
+{
+    Create(width, height);
+}
+
+bool OcrImage::Create(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        Destroy();
+        return false;
+    }
+    this->width = width;
+    this->height = height;
+    data.assign((size_t)width * height * 3, 0);
+    return true;
+}
+
+void OcrImage::Destroy()
+{
+    width = 0;
+    height = 0;
+    vector<unsigned char>().swap(data);
+}
+
+/*
+* Nearest-neighbour resampling in 16.16 fixed point, the same stepping as
+* wxImage::Scale with the default quality, so a letter rescaled here has
+* the same pixels as one rescaled by the GUI.
+*/
+OcrImage OcrImage::Scale(int newWidth, int newHeight) const
+{
+    return OcrView(*this).Scale(newWidth, newHeight);
+}
+
+OcrImage &OcrImage::Rescale(int newWidth, int newHeight)
+{
+    *this = Scale(newWidth, newHeight);
+    return *this;
+}
+
+OcrView::OcrView()
+    : data(0), stride(0), width(0), height(0)
+{
+}
+
+OcrView::OcrView(const OcrImage &image)
+    : data(image.GetData()), stride(image.GetWidth() * 3),
+    width(image.GetWidth()), height(image.GetHeight())
+{
+}
+
+OcrView::OcrView(const OcrImage &image, int x, int y, int width,
+    int height)
+{
+    *this = OcrView(image).Window(x, y, width, height);
+}
+
+OcrView OcrView::Window(int x, int y, int width, int height) const
+{
+    OcrView window;
+    if (x < 0 || y < 0 || width <= 0 || height <= 0 ||
+        x + width > this->width || y + height > this->height)
+        return window;
+    window.data = data + (size_t)y * stride + x * 3;
+    window.stride = stride;
+    window.width = width;
+    window.height = height;
+    return window;
+}
+
+OcrImage OcrView::Scale(int newWidth, int newHeight) const
+{
+    OcrImage result;
+    if (!IsOk() || !result.Create(newWidth, newHeight))
+        return result;
+
+    unsigned long x_delta = ((unsigned long)width << 16) / newWidth;
+    unsigned long y_delta = ((unsigned long)height << 16) / newHeight;
+    unsigned char *target = result.GetData();
+
+    unsigned long y = 0;
+    for (int j = 0; j < newHeight; j++)
+    {
+        const unsigned char *line = data + (y >> 16) * stride;
+        unsigned long x = 0;
+        for (int i = 0; i < newWidth; i++)
+        {
+            const unsigned char *pixel = &line[(x >> 16) * 3];
+            *target++ = pixel[0];
+            *target++ = pixel[1];
+            *target++ = pixel[2];
+            x += x_delta;
+        }
+        y += y_delta;
+    }
+    return result;
+}
+
+OcrImage OcrView::Copy() const
+{
+    OcrImage result;
+    if (!result.Create(width, height))
+        return result;
+    for (int y = 0; y < height; y++)
+    {
+        memcpy(result.GetData() + (size_t)y * width * 3, GetRow(y),
+            width * 3);
+    }
+    return result;
+}
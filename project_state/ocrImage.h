@@ -0,0 +1,105 @@
+/***************************************************************
+ * Name:      ocrImage.h
+ * Purpose:   Defines the RGB Image used by the Recognition Core
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRIMAGE_H
+#define OCRIMAGE_H
+
+#include <vector>
+
+using namespace std;
+
+/*
+* The recognition core does not depend on wxWidgets, so it has its own
+* image. It keeps the part of the wxImage interface that the filters use
+* (same names, same 3 bytes per pixel layout, same nearest-neighbour
+* Rescale) so the filters read the same as before. The GUI converts to
+* and from wxImage at its boundary.
+*/
+class OcrImage
+{
+public:
+    OcrImage();
+    OcrImage(int width, int height);
+
+    //Creates a black image
+    bool Create(int width, int height);
+    void Destroy();
+    bool IsOk() const { return width > 0 && height > 0; }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+    //Pixel Access
+    unsigned char GetRed(int x, int y) const
+        { return data[(y * width + x) * 3]; }
+    unsigned char GetGreen(int x, int y) const
+        { return data[(y * width + x) * 3 + 1]; }
+    unsigned char GetBlue(int x, int y) const
+        { return data[(y * width + x) * 3 + 2]; }
+    void SetRGB(int x, int y, unsigned char r, unsigned char g,
+        unsigned char b)
+    {
+        unsigned char *pixel = &data[(y * width + x) * 3];
+        pixel[0] = r;
+        pixel[1] = g;
+        pixel[2] = b;
+    }
+
+    //RGB Data, 3 Bytes per Pixel Row by Row
+    unsigned char *GetData() { return data.empty() ? 0 : &data[0]; }
+    const unsigned char *GetData() const
+        { return data.empty() ? 0 : &data[0]; }
+
+    //Resizing
+    OcrImage Scale(int newWidth, int newHeight) const;
+    OcrImage &Rescale(int newWidth, int newHeight);
+    OcrImage Copy() const { return *this; }
+
+private:
+    int width;
+    int height;
+    vector<unsigned char> data;
+};
+
+/*
+* A rectangle of an OcrImage that does not own its pixels, only points
+* into them. The letters segmentation_word finds are such windows of the
+* plate, so that a letter is copied once, when it is normalized into a
+* glyph. A view is only valid while its image is alive and not resized.
+*/
+class OcrView
+{
+public:
+    OcrView();
+    //The whole image, or the rectangle of it at x, y
+    OcrView(const OcrImage &image);
+    OcrView(const OcrImage &image, int x, int y, int width, int height);
+
+    bool IsOk() const { return width > 0 && height > 0; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+    //Pixel Access
+    unsigned char GetRed(int x, int y) const
+        { return data[y * stride + x * 3]; }
+    const unsigned char *GetRow(int y) const { return data + y * stride; }
+
+    //The rectangle of this view at x, y
+    OcrView Window(int x, int y, int width, int height) const;
+    //Copies, as OcrImage::Scale and OcrImage::Copy
+    OcrImage Scale(int newWidth, int newHeight) const;
+    OcrImage Copy() const;
+
+private:
+    const unsigned char *data;  //RGB of the top left pixel
+    int stride;                 //Bytes from a row to the next
+    int width;
+    int height;
+};
+
+#endif
@@ -0,0 +1,228 @@
+/***************************************************************
+ * Name:      ocrImageIO.cpp
+ * Purpose:   Code for Image Decoding for the Recognition Core
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include "ocrImageIO.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#ifdef OCR_HAVE_PNG
+#include <png.h>
+#endif
+#ifdef OCR_HAVE_JPEG
+#include <jpeglib.h>
+#include <setjmp.h>
+#endif
+
+using namespace std;
+
+//Functions
+bool load_bmp(const unsigned char *bytes, size_t size, OcrImage &image);
+bool load_pnm(const unsigned char *bytes, size_t size, OcrImage &image);
+bool load_png(const unsigned char *bytes, size_t size, OcrImage &image);
+bool load_jpeg(const unsigned char *bytes, size_t size, OcrImage &image);
+unsigned int read_le(const unsigned char *bytes, int count);
+
+//Loading Functions
+bool load_image(const string &filename, OcrImage &image)
+{
+    ifstream myfile (filename.c_str(), ios::binary);
+    if (!myfile.is_open())
+        return false;
+    vector<unsigned char> bytes((istreambuf_iterator<char>(myfile)),
+        istreambuf_iterator<char>());
+    if (bytes.empty())
+        return false;
+    return load_image_memory(&bytes[0], bytes.size(), image);
+}
+
+bool load_image_memory(const unsigned char *bytes, size_t size,
+    OcrImage &image)
+{
+    if (size < 4)
+        return false;
+    if (bytes[0] == 'B' && bytes[1] == 'M')
+        return load_bmp(bytes, size, image);
+    if (bytes[0] == 'P' && (bytes[1] == '5' || bytes[1] == '6'))
+        return load_pnm(bytes, size, image);
+    if (bytes[0] == 0x89 && bytes[1] == 'P' && bytes[2] == 'N' &&
+        bytes[3] == 'G')
+        return load_png(bytes, size, image);
+    if (bytes[0] == 0xFF && bytes[1] == 0xD8)
+        return load_jpeg(bytes, size, image);
+    return false;
+}
+
+/*
+* Windows bitmaps are stored bottom-up (unless the height is negative)
+* as BGR rows padded to 4 bytes.
+*/
+bool load_bmp(const unsigned char *bytes, size_t size, OcrImage &image)
+{
+    if (size < 54)
+        return false;
+    unsigned int offset = read_le(bytes + 10, 4);
+    int width = (int)read_le(bytes + 18, 4);
+    int height = (int)read_le(bytes + 22, 4);
+    int bits = read_le(bytes + 28, 2);
+    int compression = read_le(bytes + 30, 4);
+    if ((bits != 24 && bits != 32) || (compression != 0 && compression != 3))
+        return false;
+
+    bool bottom_up = height > 0;
+    if (!bottom_up)
+        height = -height;
+    int step = bits / 8;
+    size_t stride = ((size_t)width * step + 3) & ~(size_t)3;
+    if (width <= 0 || height <= 0 || offset + stride * height > size)
+        return false;
+
+    image.Create(width, height);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char *row =
+            bytes + offset + stride * (bottom_up ? height - 1 - y : y);
+        for (int x = 0; x < width; x++)
+        {
+            const unsigned char *pixel = row + x * step;
+            image.SetRGB(x, y, pixel[2], pixel[1], pixel[0]);
+        }
+    }
+    return true;
+}
+
+//Binary Netpbm: P5 (gray) and P6 (RGB) with 8-bit samples
+bool load_pnm(const unsigned char *bytes, size_t size, OcrImage &image)
+{
+    int values[3];
+    size_t p = 2;
+    for (int v = 0; v < 3; v++)
+    {
+        //Skips Whitespace and Comments
+        while (p < size && (isspace(bytes[p]) || bytes[p] == '#'))
+        {
+            if (bytes[p] == '#')
+                while (p < size && bytes[p] != '\n')
+                    p++;
+            else
+                p++;
+        }
+        values[v] = 0;
+        while (p < size && isdigit(bytes[p]))
+            values[v] = values[v] * 10 + (bytes[p++] - '0');
+    }
+    p++;
+
+    int width = values[0];
+    int height = values[1];
+    int channels = (bytes[1] == '6') ? 3 : 1;
+    if (width <= 0 || height <= 0 || values[2] != 255 ||
+        p + (size_t)width * height * channels > size)
+        return false;
+
+    image.Create(width, height);
+    const unsigned char *pixel = bytes + p;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (channels == 3)
+                image.SetRGB(x, y, pixel[0], pixel[1], pixel[2]);
+            else
+                image.SetRGB(x, y, pixel[0], pixel[0], pixel[0]);
+            pixel += channels;
+        }
+    }
+    return true;
+}
+
+bool load_png(const unsigned char *bytes, size_t size, OcrImage &image)
+{
+#ifdef OCR_HAVE_PNG
+    png_image png;
+    memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&png, bytes, size))
+        return false;
+
+    //Transparent Pixels are Composed on White
+    png_color white = { 255, 255, 255 };
+    png.format = PNG_FORMAT_RGB;
+    image.Create(png.width, png.height);
+    if (!png_image_finish_read(&png, &white, image.GetData(), 0, NULL))
+    {
+        png_image_free(&png);
+        image.Destroy();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef OCR_HAVE_JPEG
+struct JpegError
+{
+    jpeg_error_mgr manager;
+    jmp_buf escape;
+};
+
+void jpeg_fail(j_common_ptr info)
+{
+    longjmp(((JpegError *)info->err)->escape, 1);
+}
+#endif
+
+bool load_jpeg(const unsigned char *bytes, size_t size, OcrImage &image)
+{
+#ifdef OCR_HAVE_JPEG
+    jpeg_decompress_struct info;
+    JpegError error;
+    info.err = jpeg_std_error(&error.manager);
+    error.manager.error_exit = jpeg_fail;
+    if (setjmp(error.escape))
+    {
+        jpeg_destroy_decompress(&info);
+        image.Destroy();
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, (unsigned char *)bytes, size);
+    jpeg_read_header(&info, TRUE);
+    info.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&info);
+
+    image.Create(info.output_width, info.output_height);
+    while (info.output_scanline < info.output_height)
+    {
+        JSAMPROW row = image.GetData() +
+            (size_t)info.output_scanline * info.output_width * 3;
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+#else
+    return false;
+#endif
+}
+
+//Supplementary Code
+unsigned int read_le(const unsigned char *bytes, int count)
+{
+    unsigned int value = 0;
+    for (int i = count - 1; i >= 0; i--)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
@@ -0,0 +1,31 @@
+/***************************************************************
+ * Name:      ocrImageIO.h
+ * Purpose:   Defines Image Decoding for the Recognition Core
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRIMAGEIO_H
+#define OCRIMAGEIO_H
+
+#include <stddef.h>
+#include <string>
+#include "ocrImage.h"
+
+using namespace std;
+
+/*
+* BMP (24 and 32 bits, uncompressed) and PPM/PGM are always read.
+* PNG and JPEG are read when the core is built with libpng (OCR_HAVE_PNG)
+* and libjpeg (OCR_HAVE_JPEG). The format is found from the first bytes,
+* not from the file name. Other formats are left to the GUI, which loads
+* them through wxImage.
+*/
+
+//Loading Functions
+bool load_image(const string &filename, OcrImage &image);
+bool load_image_memory(const unsigned char *bytes, size_t size,
+    OcrImage &image);
+
+#endif
@@ -0,0 +1,683 @@
+/***************************************************************
+ * Name:      ocrLoad.cpp
+ * Purpose:   Open-Loop Load Generator and Latency Report of the
+ *            Recognizer, In-Process or through the Daemon
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include <dirent.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ocrAppEngine.h"
+#include "ocrAppHistogram.h"
+#include "ocrImageIO.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+//Definitions
+#define LOAD_SATURATED 0.95  //Share of the offered rate a run must serve
+                             //not to count as saturated
+
+//Where the Requests Go: the Daemon if either is Set
+struct LoadTarget
+{
+    string socket_path;
+    int port;
+};
+
+//Latencies of a Run at one Rate, in Microseconds
+struct LoadRun
+{
+    OcrHistogram total;               //Arrival to answer
+    OcrHistogram queue;               //Arrival to start
+    OcrHistogram decode;              //In-process only
+    OcrHistogram stages[NUM_STAGES];  //In-process only
+    long arrivals, done, failed, dropped;
+    long skipped;                     //Done, but Turned Down by the Gate
+    double seconds;                   //Start to the last answer
+
+    LoadRun() : arrivals(0), done(0), failed(0), dropped(0), skipped(0),
+        seconds(0) {}
+};
+
+//Functions
+vector<double> schedule(double rate, double seconds, bool poisson,
+    uint32_t seed);
+void run_engine(const OcrEngine &engine, OcrPool &pool,
+    const vector< vector<unsigned char> > &images,
+    const vector<double> &arrivals, int limit, LoadRun &run);
+void run_daemon(const LoadTarget &target, const vector<string> &requests,
+    const vector<double> &arrivals, int connections, int limit,
+    LoadRun &run);
+int connect_daemon(const LoadTarget &target);
+bool send_all(int fd, const string &text);
+bool read_reply(int fd, string &buffer, string &line);
+bool add_inputs(const string &path, vector<string> &files);
+bool read_file(const string &path, vector<unsigned char> &bytes);
+int64_t micros(Clock::duration duration);
+void print_row(const char *name, const OcrHistogram &histogram);
+void usage();
+
+/*
+* Replays the images at a fixed rate of arrivals whatever the recognizer
+* does (open loop), once per rate asked for, and reports the latency
+* percentiles of each run and the rates it could not keep up with.
+*
+* A request is timed from when it was due to arrive, not from when it
+* could be sent: a closed loop that waits for every answer before the
+* next request, or times only from sending, leaves out the waiting that
+* a stalled recognizer makes later requests do, and reports the tail
+* far better than it is. The arrivals are spaced by a seeded generator,
+* so two runs with the same options offer the same load.
+*/
+int main(int argc, char **argv)
+{
+    string trainset = "trainset";
+    string formats = "grammar.txt";
+    string matcher = "pixels";
+    int glyph = GLYPH_LARGE;
+    string compact = "off";
+    string gate = "off";
+    int threads = 0;
+    LoadTarget target;
+    target.port = 0;
+    int connections = 8;
+    string rates = "50,200,1000";
+    double duration = 5;
+    string arrivals = "poisson";
+    uint32_t seed = 1;
+    int limit = 1000;
+    double slo = 0;
+    vector<string> files;
+
+    //Command Line Options
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            if (!add_inputs(arg, files))
+            {
+                fprintf(stderr, "cannot read %s\n", arg.c_str());
+                return 1;
+            }
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            usage();
+            return 1;
+        }
+        if (arg == "--trainset")
+            trainset = argv[++i];
+        else if (arg == "--grammar")
+            formats = argv[++i];
+        else if (arg == "--matcher")
+            matcher = argv[++i];
+        else if (arg == "--glyph")
+            glyph = atoi(argv[++i]);
+        else if (arg == "--compact")
+            compact = argv[++i];
+        else if (arg == "--gate")
+            gate = argv[++i];
+        else if (arg == "--threads")
+            threads = atoi(argv[++i]);
+        else if (arg == "--socket")
+            target.socket_path = argv[++i];
+        else if (arg == "--port")
+            target.port = atoi(argv[++i]);
+        else if (arg == "--connections")
+            connections = atoi(argv[++i]);
+        else if (arg == "--rates")
+            rates = argv[++i];
+        else if (arg == "--duration")
+            duration = atof(argv[++i]);
+        else if (arg == "--arrivals")
+            arrivals = argv[++i];
+        else if (arg == "--seed")
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (arg == "--outstanding")
+            limit = atoi(argv[++i]);
+        else if (arg == "--slo")
+            slo = atof(argv[++i]);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    //Rates, Comma Separated
+    vector<double> offered;
+    for (size_t begin = 0; begin <= rates.size();)
+    {
+        size_t end = rates.find(',', begin);
+        if (end == string::npos)
+            end = rates.size();
+        double rate = atof(rates.substr(begin, end - begin).c_str());
+        if (rate <= 0)
+        {
+            usage();
+            return 1;
+        }
+        offered.push_back(rate);
+        begin = end + 1;
+    }
+    bool daemon = !target.socket_path.empty() || target.port > 0;
+    if (files.empty() || duration <= 0 || limit < 1 || connections < 1 ||
+        (arrivals != "poisson" && arrivals != "uniform") ||
+        (matcher != "pixels" && matcher != "chamfer"))
+    {
+        usage();
+        return 1;
+    }
+
+    //Images are Read Once and Decoded by every Request
+    vector< vector<unsigned char> > images;
+    vector<string> requests;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        vector<unsigned char> bytes;
+        OcrImage image;
+        if (!read_file(files[i], bytes) || bytes.empty())
+        {
+            fprintf(stderr, "cannot read %s\n", files[i].c_str());
+            return 1;
+        }
+        //Formats Left to the GUI would only Fail
+        if (!load_image_memory(&bytes[0], bytes.size(), image))
+        {
+            fprintf(stderr, "skipping %s, which the core cannot decode\n",
+                files[i].c_str());
+            continue;
+        }
+        char header[64];
+        sprintf(header, "RECOGNIZE 1\nDATA %d\n", (int)bytes.size());
+        requests.push_back(header);
+        requests.back().append(bytes.begin(), bytes.end());
+        images.push_back(bytes);
+    }
+    if (images.empty())
+    {
+        fprintf(stderr, "no image to replay\n");
+        return 1;
+    }
+
+    OcrEngine engine;
+    unique_ptr<OcrPool> pool;
+    if (!daemon)
+    {
+        if (!engine.train(trainset))
+        {
+            fprintf(stderr, "cannot load the training set from %s\n",
+                trainset.c_str());
+            return 1;
+        }
+        engine.load_formats(formats);
+        if (!engine.set_glyph_size(glyph) ||
+            (compact != "on" && compact != "off") ||
+            (gate != "on" && gate != "off"))
+        {
+            usage();
+            return 1;
+        }
+        engine.set_compact(compact == "on");
+        engine.set_gate(gate == "on");
+        if (matcher == "chamfer")
+            engine.set_matcher(MATCH_CHAMFER);
+
+        //Requests and their Letters Share the Threads, as in the Daemon
+        pool.reset(new OcrPool(threads));
+        engine.set_pool(pool.get());
+    }
+    else
+    {
+        int fd = connect_daemon(target);
+        if (fd < 0)
+        {
+            perror("connect");
+            return 1;
+        }
+        close(fd);
+    }
+
+    //Every Image Once, so the First Run does not Pay for Cold Caches
+    {
+        LoadRun warm;
+        vector<double> burst(images.size(), 0.0);
+        if (daemon)
+            run_daemon(target, requests, burst, 1, (int)burst.size(), warm);
+        else
+            run_engine(engine, *pool, images, burst, (int)burst.size(), warm);
+    }
+
+    printf("%d images, %s arrivals for %.1f s per rate, %s\n",
+        (int)images.size(), arrivals.c_str(), duration,
+        daemon ? "through the daemon" : "in process");
+    if (!daemon)
+    {
+        printf("%d threads, %s matcher\n", pool->size(), matcher.c_str());
+    }
+
+    //Runs
+    vector<string> summary;
+    double sustained = 0, saturated = 0;
+    for (size_t r = 0; r < offered.size(); r++)
+    {
+        LoadRun run;
+        vector<double> due = schedule(offered[r], duration,
+            arrivals == "poisson", seed);
+        if (daemon)
+            run_daemon(target, requests, due, connections, limit, run);
+        else
+            run_engine(engine, *pool, images, due, limit, run);
+
+        double served = run.done / max(run.seconds, duration);
+        printf("\nrate %.0f/s: %ld arrivals, %ld done, %ld failed, "
+            "%ld dropped, %.1f/s served\n", offered[r], run.arrivals,
+            run.done, run.failed, run.dropped, served);
+        if (engine.gate_enabled())
+            printf("%ld of the done skipped by the gate\n", run.skipped);
+        printf("%-10s %9s %9s %9s %9s %9s\n", "", "p50 ms", "p90 ms",
+            "p99 ms", "p99.9 ms", "max ms");
+        print_row("queue", run.queue);
+        if (!daemon)
+        {
+            print_row("decode", run.decode);
+            for (int s = 0; s < NUM_STAGES; s++)
+                print_row(stage_names[s], run.stages[s]);
+        }
+        print_row("total", run.total);
+
+        //Saturated when it Serves less than it is Offered
+        const char *status = "ok";
+        if (served < LOAD_SATURATED * run.arrivals / duration ||
+            run.dropped > 0 || run.failed > 0)
+        {
+            status = "saturated";
+            if (saturated == 0)
+                saturated = offered[r];
+        }
+        else if (slo > 0 && run.total.percentile(99) > slo * 1000)
+            status = "over slo";
+        else if (offered[r] > sustained)
+            sustained = offered[r];
+
+        char row[160];
+        sprintf(row, "%10.0f %10.1f %8ld %8ld %9.2f %9.2f %9.2f  %s",
+            offered[r], served, run.dropped, run.failed,
+            run.total.percentile(50) / 1000.0,
+            run.total.percentile(99) / 1000.0,
+            run.total.percentile(99.9) / 1000.0, status);
+        summary.push_back(row);
+    }
+
+    printf("\n%10s %10s %8s %8s %9s %9s %9s\n", "offered/s", "served/s",
+        "dropped", "failed", "p50 ms", "p99 ms", "p99.9 ms");
+    for (size_t r = 0; r < summary.size(); r++)
+        printf("%s\n", summary[r].c_str());
+    if (sustained > 0)
+        printf("sustained up to %.0f/s", sustained);
+    else
+        printf("no rate sustained");
+    if (slo > 0)
+        printf(" within a p99 of %.1f ms", slo);
+    if (saturated > 0)
+        printf(", saturated at %.0f/s\n", saturated);
+    else
+        printf(", not saturated\n");
+    return 0;
+}
+
+//Seconds from the Start at which the Requests Arrive
+vector<double> schedule(double rate, double seconds, bool poisson,
+    uint32_t seed)
+{
+    vector<double> times;
+    mt19937 generator(seed);
+    double t = 0;
+    while (true)
+    {
+        //Exponential Gaps, from the Bits of mt19937 (which are the Same
+        //Everywhere) rather than from a Library's Distribution
+        if (poisson)
+            t -= log((generator() + 0.5) / 4294967296.0) / rate;
+        else
+            t = times.size() / rate;
+        if (t >= seconds)
+            break;
+        times.push_back(t);
+    }
+    return times;
+}
+
+/*
+* Hands every request to the pool when it is due, the way the daemon
+* does, and drops it instead when limit requests are already waiting or
+* running. The requests are timed until the pool has finished them all.
+*/
+void run_engine(const OcrEngine &engine, OcrPool &pool,
+    const vector< vector<unsigned char> > &images,
+    const vector<double> &arrivals, int limit, LoadRun &run)
+{
+    mutex lock;
+    condition_variable idle;
+    int outstanding = 0;
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+
+    for (size_t i = 0; i < arrivals.size(); i++)
+    {
+        Clock::time_point due = start +
+            chrono::duration_cast<Clock::duration>(
+            chrono::duration<double>(arrivals[i]));
+        this_thread::sleep_until(due);
+        {
+            lock_guard<mutex> guard(lock);
+            run.arrivals++;
+            if (outstanding >= limit)
+            {
+                run.dropped++;
+                continue;
+            }
+            outstanding++;
+        }
+
+        const vector<unsigned char> *bytes = &images[i % images.size()];
+        pool.submit([&, due, bytes]()
+        {
+            Clock::time_point begin = Clock::now();
+            OcrImage image;
+            PlateResult result;
+            bool loaded = load_image_memory(&(*bytes)[0], bytes->size(),
+                image);
+            Clock::time_point decoded = Clock::now();
+            if (loaded)
+                engine.recognize(image, result);
+            Clock::time_point end = Clock::now();
+
+            lock_guard<mutex> guard(lock);
+            run.queue.record(micros(begin - due));
+            if (loaded)
+            {
+                run.decode.record(micros(decoded - begin));
+                for (int s = 0; s < NUM_STAGES; s++)
+                    run.stages[s].record((int64_t)result.timings[s]);
+                run.total.record(micros(end - due));
+                run.done++;
+                if (result.rejected != GATE_PASSED)
+                    run.skipped++;
+            }
+            else
+                run.failed++;
+            if (end > last)
+                last = end;
+            if (--outstanding == 0)
+                idle.notify_all();
+        });
+    }
+
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [&]() { return outstanding == 0; });
+    run.seconds = chrono::duration<double>(last - start).count();
+}
+
+/*
+* Each connection sends one RECOGNIZE at a time, so requests due while
+* all of them are busy wait in a queue here, and that wait is part of
+* their latency. A request is dropped when limit requests are already
+* queued, and failed when the daemon answers with an error (busy or
+* timeout) or the connection breaks.
+*/
+void run_daemon(const LoadTarget &target, const vector<string> &requests,
+    const vector<double> &arrivals, int connections, int limit,
+    LoadRun &run)
+{
+    mutex lock;
+    condition_variable ready;
+    deque< pair<size_t, Clock::time_point> > waiting;
+    bool closing = false;
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+
+    vector<thread> clients;
+    for (int c = 0; c < connections; c++)
+    {
+        clients.push_back(thread([&]()
+        {
+            int fd = connect_daemon(target);
+            string buffer, line;
+            while (true)
+            {
+                size_t index;
+                Clock::time_point due;
+                {
+                    unique_lock<mutex> guard(lock);
+                    ready.wait(guard, [&]()
+                        { return closing || !waiting.empty(); });
+                    if (waiting.empty())
+                        break;
+                    index = waiting.front().first;
+                    due = waiting.front().second;
+                    waiting.pop_front();
+                }
+
+                Clock::time_point begin = Clock::now();
+                if (fd < 0)
+                    fd = connect_daemon(target);
+                bool answered = fd >= 0 &&
+                    send_all(fd, requests[index % requests.size()]) &&
+                    read_reply(fd, buffer, line);
+                Clock::time_point end = Clock::now();
+                if (!answered && fd >= 0)
+                {
+                    close(fd);
+                    fd = -1;
+                    buffer.clear();
+                }
+
+                lock_guard<mutex> guard(lock);
+                run.queue.record(micros(begin - due));
+                if (answered && line.find("\"error\"") == string::npos)
+                {
+                    run.total.record(micros(end - due));
+                    run.done++;
+                }
+                else
+                    run.failed++;
+                if (end > last)
+                    last = end;
+            }
+            if (fd >= 0)
+                close(fd);
+        }));
+    }
+
+    for (size_t i = 0; i < arrivals.size(); i++)
+    {
+        Clock::time_point due = start +
+            chrono::duration_cast<Clock::duration>(
+            chrono::duration<double>(arrivals[i]));
+        this_thread::sleep_until(due);
+        lock_guard<mutex> guard(lock);
+        run.arrivals++;
+        if ((int)waiting.size() >= limit)
+        {
+            run.dropped++;
+            continue;
+        }
+        waiting.push_back(make_pair(i, due));
+        ready.notify_one();
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        closing = true;
+        ready.notify_all();
+    }
+    for (size_t c = 0; c < clients.size(); c++)
+        clients[c].join();
+    run.seconds = chrono::duration<double>(last - start).count();
+}
+
+//Supplementary Code
+int connect_daemon(const LoadTarget &target)
+{
+    int fd;
+    if (!target.socket_path.empty())
+    {
+        sockaddr_un address;
+        if (target.socket_path.size() >= sizeof(address.sun_path))
+            return -1;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, target.socket_path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 &&
+            connect(fd, (sockaddr *)&address, sizeof(address)) == 0)
+            return fd;
+    }
+    else
+    {
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(target.port);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 &&
+            connect(fd, (sockaddr *)&address, sizeof(address)) == 0)
+            return fd;
+    }
+    if (fd >= 0)
+        close(fd);
+    return -1;
+}
+
+bool send_all(int fd, const string &text)
+{
+    size_t sent = 0;
+    while (sent < text.size())
+    {
+        ssize_t put = send(fd, text.data() + sent, text.size() - sent,
+            MSG_NOSIGNAL);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            return false;
+        sent += put;
+    }
+    return true;
+}
+
+bool read_reply(int fd, string &buffer, string &line)
+{
+    size_t end;
+    while ((end = buffer.find('\n')) == string::npos)
+    {
+        char chunk[4096];
+        ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return false;
+        buffer.append(chunk, got);
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+//Adds a file, or the files of a directory in the order of their names
+bool add_inputs(const string &path, vector<string> &files)
+{
+    DIR *dir = opendir(path.c_str());
+    if (dir == NULL)
+    {
+        if (errno == ENOTDIR)
+        {
+            files.push_back(path);
+            return true;
+        }
+        return false;
+    }
+    vector<string> names;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] != '.')
+            names.push_back(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+    sort(names.begin(), names.end());
+    files.insert(files.end(), names.begin(), names.end());
+    return true;
+}
+
+bool read_file(const string &path, vector<unsigned char> &bytes)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+    unsigned char chunk[65536];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        bytes.insert(bytes.end(), chunk, chunk + got);
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+int64_t micros(Clock::duration duration)
+{
+    return chrono::duration_cast<chrono::microseconds>(duration).count();
+}
+
+void print_row(const char *name, const OcrHistogram &histogram)
+{
+    printf("%-10s %9.2f %9.2f %9.2f %9.2f %9.2f\n", name,
+        histogram.percentile(50) / 1000.0,
+        histogram.percentile(90) / 1000.0,
+        histogram.percentile(99) / 1000.0,
+        histogram.percentile(99.9) / 1000.0,
+        histogram.max() / 1000.0);
+}
+
+void usage()
+{
+    fprintf(stderr,
+        "usage: ocrLoad [--rates <n,n,...>] [--duration <seconds>]\n"
+        "               [--arrivals poisson|uniform] [--seed <n>]\n"
+        "               [--outstanding <n>] [--slo <p99 ms>]\n"
+        "               [--socket <path> | --port <port>]\n"
+        "               [--connections <n>]\n"
+        "               [--trainset <dir>] [--grammar <file>]\n"
+        "               [--matcher pixels|chamfer] [--glyph <size>]\n"
+        "               [--compact on|off] [--gate on|off]\n"
+        "               [--threads <n>]\n"
+        "               <image or directory>...\n"
+        "The engine options apply in process; with --socket or --port\n"
+        "the daemon is loaded as it was started.\n");
+}
@@ -0,0 +1,23 @@
+/***************************************************************
+ * Name:      ocrTest.h
+ * Purpose:   Checks shared by the Test Programs
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#ifndef OCRTEST_H
+#define OCRTEST_H
+
+#include <stdio.h>
+
+//Failed checks of the program, its exit status is 1 if there are any
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { if (!(condition)) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+            #condition); \
+        failures++; } } while (0)
+
+#endif
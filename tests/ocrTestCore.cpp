@@ -0,0 +1,1338 @@
+/***************************************************************
+ * Name:      ocrTestCore.cpp
+ * Purpose:   Checks of the Recognition Core
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "ocrAppEngine.h"
+#include "ocrAppPipeline.h"
+#include "ocrAppWriter.h"
+#include "ocrAppHistogram.h"
+#include "ocrAppFusion.h"
+#include "ocrAppPrepro.h"
+#include "ocrImageIO.h"
+#include "ocrTest.h"
+
+using namespace std;
+
+//Every batch kernel gives the scores of the scalar match_scores, with
+//the kernels specialized for a glyph size and with the generic loops
+void check_batch_kernels(int size, int numTemplates)
+{
+    const int numPixels = size * size;
+    const int numGlyphs = 5;
+    const int words = WORDS_FOR(numPixels);
+    vector<unsigned char> glyphs(numGlyphs * numPixels * 3);
+    vector<unsigned char> temps(numTemplates * numPixels * 3);
+    srand(size);
+    for (size_t i = 0; i < glyphs.size(); i++)
+        glyphs[i] = (rand() & 1) ? 255 : 0;
+    for (size_t i = 0; i < temps.size(); i++)
+        temps[i] = (rand() & 1) ? 255 : 0;
+
+    vector<uint64_t> glyphbits(numGlyphs * words);
+    vector<uint64_t> tempbits(numTemplates * words);
+    vector<const unsigned char *> templates(numTemplates);
+    for (int g = 0; g < numGlyphs; g++)
+        pack_bits(&glyphs[g * numPixels * 3], numPixels, &glyphbits[g * words]);
+    for (int t = 0; t < numTemplates; t++)
+    {
+        pack_bits(&temps[t * numPixels * 3], numPixels, &tempbits[t * words]);
+        templates[t] = &temps[t * numPixels * 3];
+    }
+
+    const char *kernels[] = { "generic", "popcnt", "avx512" };
+    for (int k = 0; k < 3; k++)
+    {
+        if (!use_batch_kernel(kernels[k]))
+            continue;
+        vector<int> stat(numGlyphs * numTemplates);
+        match_scores_batch(&glyphbits[0], numGlyphs, &tempbits[0],
+            numTemplates, numPixels, &stat[0]);
+        for (int g = 0; g < numGlyphs; g++)
+        {
+            vector<int> expected(numTemplates);
+            match_scores(&glyphs[g * numPixels * 3], &templates[0],
+                numTemplates, numPixels, &expected[0]);
+            for (int t = 0; t < numTemplates; t++)
+                CHECK(stat[g * numTemplates + t] == expected[t]);
+        }
+    }
+}
+
+void test_batch_kernels()
+{
+    //Banks of NUM_TEMPLATES, and of the Counts Online Training Leaves
+    for (int i = 0; i < NUM_GLYPH_SIZES; i++)
+    {
+        check_batch_kernels(glyph_sizes[i], NUM_TEMPLATES);
+        check_batch_kernels(glyph_sizes[i], NUM_TEMPLATES + 1);
+        check_batch_kernels(glyph_sizes[i], 13);
+    }
+    for (int size = GLYPH_LARGE / 4; size <= GLYPH_LARGE / 2; size *= 2)
+    {
+        check_batch_kernels(size, NUM_TEMPLATES);
+        check_batch_kernels(size, NUM_TEMPLATES + 1);
+        check_batch_kernels(size, NUM_TEMPLATES - 1);
+    }
+    check_batch_kernels(37, NUM_TEMPLATES + 1);
+}
+
+//The fixed-size rescale gives the pixels of OcrImage::Rescale
+void test_rescale_glyph()
+{
+    const int sizes[] = { 7, 31, 100, 128, 333 };
+    srand(2);
+    for (int s = 0; s < 5; s++)
+    {
+        OcrImage letter(sizes[s], sizes[4 - s] / 2 + 1);
+        unsigned char *data = letter.GetData();
+        for (int i = 0; i < letter.GetWidth() * letter.GetHeight() * 3; i++)
+            data[i] = rand() & 0xff;
+        for (int g = 0; g < NUM_GLYPH_SIZES; g++)
+        {
+            OcrImage fixed = letter.Copy();
+            rescale_glyph(fixed, glyph_sizes[g]);
+            OcrImage scaled = letter.Scale(glyph_sizes[g], glyph_sizes[g]);
+            int bytes = glyph_sizes[g] * glyph_sizes[g] * 3;
+            CHECK(fixed.GetWidth() == glyph_sizes[g]);
+            CHECK(memcmp(fixed.GetData(), scaled.GetData(), bytes) == 0);
+        }
+    }
+}
+
+//A pyramid level is packed with the pixels of the rescaled glyph
+void test_pack_bits_scaled()
+{
+    const int sizes[] = { 32, 64, 100, 37 };
+    srand(3);
+    for (int s = 0; s < 4; s++)
+    {
+        OcrImage glyph(sizes[s], sizes[s]);
+        unsigned char *data = glyph.GetData();
+        for (int i = 0; i < sizes[s] * sizes[s]; i++)
+            data[i * 3] = data[i * 3 + 1] = data[i * 3 + 2] =
+                (rand() & 1) ? 255 : 0;
+        for (int l = 1; l < PYRAMID_LEVELS; l++)
+        {
+            int lsize = PYRAMID_SIZE(sizes[s], l);
+            int words = WORDS_FOR(lsize * lsize);
+            OcrImage coarse = glyph.Copy();
+            rescale_glyph(coarse, lsize);
+            vector<uint64_t> expected(words), bits(words, ~0ULL);
+            pack_bits(coarse.GetData(), lsize * lsize, &expected[0]);
+            pack_bits_scaled(glyph.GetData(), sizes[s], lsize, &bits[0]);
+            CHECK(bits == expected);
+        }
+    }
+}
+
+//The partial selection keeps the k best scores, later templates on ties
+void test_top_candidates()
+{
+    int stat[8] = { 5, 9, -1, 9, 2, 7, 9, 1 };
+    Candidate top[TOP_K];
+    int count = top_candidates(stat, 8, 10, top, TOP_K);
+    CHECK(count == 3);
+    CHECK(top[0].index == 6 && top[1].index == 3 && top[2].index == 1);
+    CHECK(char_confidence(top, count) == 0);
+}
+
+//Every format of an image is read the same way
+void test_recognize()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+
+    const char *files[] = {
+        "FileFmt_BMP_Sample_Alphabet.bmp",
+        "FileFmt_PNG_Sample_Alphabet.png",
+        "FileFmt_JPEG_Sample_Alphabet.jpg"
+    };
+    string first;
+    for (int i = 0; i < 3; i++)
+    {
+        OcrImage image;
+        if (!load_image(string(OCR_TEST_FILES_DIR) + "/" + files[i], image))
+        {
+            //PNG and JPEG depend on the libraries found by the build
+            CHECK(i > 0);
+            continue;
+        }
+        PlateResult result;
+        engine.recognize(image, result);
+        printf("%s: %s (%.2f)\n", files[i], result.word.c_str(),
+            result.confidence);
+        CHECK(result.num_letters > 0);
+        CHECK((int)result.word.size() == result.num_letters);
+    }
+}
+
+//Changing the glyph size rebuilds the templates from the training set
+void test_glyph_sizes()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+
+    OcrImage image;
+    CHECK(load_image(string(OCR_TEST_FILES_DIR) +
+        "/FileFmt_BMP_Sample_Alphabet.bmp", image));
+    PlateResult large;
+    engine.recognize(image, large);
+    for (int i = 0; i < NUM_GLYPH_SIZES; i++)
+    {
+        CHECK(engine.set_glyph_size(glyph_sizes[i]));
+        CHECK(engine.glyph_size() == glyph_sizes[i]);
+        PlateResult result;
+        engine.recognize(image, result);
+        CHECK(result.num_letters == large.num_letters);
+        if (glyph_sizes[i] == GLYPH_LARGE)
+            CHECK(result.word == large.word);
+    }
+    CHECK(!engine.set_glyph_size(0));
+}
+
+//Letters that escalate to the full glyph get the scores of no pyramid
+void test_pyramid()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+
+    OcrImage image;
+    CHECK(load_image(string(OCR_TEST_FILES_DIR) +
+        "/FileFmt_BMP_Sample_Alphabet.bmp", image));
+    PlateResult full, escalated, coarse;
+    engine.recognize(image, full);
+
+    //No margin is ever reached, every letter goes down to level 0
+    CHECK(engine.set_pyramid(PYRAMID_LEVELS, 2));
+    engine.recognize(image, escalated);
+    CHECK(escalated.word == full.word);
+    for (int i = 0; i < full.num_letters; i++)
+    {
+        CHECK(escalated.chars[i].level == 0);
+        for (int t = 0; t < NUM_TEMPLATES; t++)
+            CHECK(escalated.scores[i][t] == full.scores[i][t]);
+    }
+
+    //Every margin is reached, every letter is decided at the coarsest
+    CHECK(engine.set_pyramid(PYRAMID_LEVELS, 0));
+    engine.recognize(image, coarse);
+    CHECK(coarse.num_letters == full.num_letters);
+    for (int i = 0; i < coarse.num_letters; i++)
+        CHECK(coarse.chars[i].level == PYRAMID_LEVELS - 1);
+
+    CHECK(!engine.set_pyramid(PYRAMID_LEVELS + 1, 0));
+    CHECK(!engine.set_pyramid(1, -1));
+}
+
+//Stages are made once, and again only when what they come from changes
+void test_pipeline()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+
+    OcrImage image;
+    CHECK(load_image(string(OCR_TEST_FILES_DIR) +
+        "/FileFmt_BMP_Sample_Alphabet.bmp", image));
+    PlateResult direct;
+    engine.recognize(image, direct);
+
+    OcrPipeline pipeline(engine);
+    CHECK(!pipeline.has_source());
+    CHECK(pipeline.result() == NULL);
+    pipeline.set_source(image);
+    shared_ptr<const PlateResult> result = pipeline.result();
+    CHECK(pipeline.runs() == 5);
+    CHECK(result->word == direct.word);
+    CHECK(result->num_letters == direct.num_letters);
+    for (int i = 0; i < direct.num_letters; i++)
+    {
+        for (int t = 0; t < NUM_TEMPLATES; t++)
+            CHECK(result->scores[i][t] == direct.scores[i][t]);
+    }
+    //The Source is Left as it was
+    CHECK(memcmp(pipeline.source()->GetData(), image.GetData(),
+        image.GetWidth() * image.GetHeight() * 3) == 0);
+
+    //Nothing Changed
+    CHECK(pipeline.result() == result);
+    CHECK(pipeline.runs() == 5);
+
+    //Another Matcher Only Scores Again
+    shared_ptr<const OcrGlyphs> glyphs = pipeline.glyphs();
+    engine.set_matcher(MATCH_CHAMFER);
+    shared_ptr<const PlateResult> chamfer = pipeline.result();
+    CHECK(pipeline.runs() == 6);
+    CHECK(pipeline.glyphs() == glyphs);
+    CHECK(chamfer != result);
+    CHECK(chamfer->num_letters == result->num_letters);
+
+    //Another Glyph Size Cuts the Letters Again
+    shared_ptr<const OcrImage> plate = pipeline.plate();
+    CHECK(engine.set_glyph_size(GLYPH_SMALL));
+    pipeline.result();
+    CHECK(pipeline.runs() == 8);
+    CHECK(pipeline.plate() == plate);
+    CHECK(pipeline.glyphs() != glyphs);
+    CHECK(pipeline.glyphs()->letters[0].GetWidth() == GLYPH_SMALL);
+
+    //Another Source Redoes Everything
+    pipeline.set_source(image);
+    pipeline.result();
+    CHECK(pipeline.runs() == 13);
+    CHECK(pipeline.plate() != plate);
+}
+
+//Records come back from both logs as they were written, in order
+void test_writer()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+    OcrImage image;
+    CHECK(load_image(string(OCR_TEST_FILES_DIR) +
+        "/FileFmt_BMP_Sample_Alphabet.bmp", image));
+    PlateResult result;
+    engine.recognize(image, result);
+    for (int s = 0; s < NUM_STAGES; s++)
+        CHECK(result.timings[s] >= 0);
+    CHECK(result.timings[STAGE_GRAY] > 0);
+
+    const char *jsonl = "ocrTestCore.jsonl";
+    const char *log = "ocrTestCore.log";
+    remove(jsonl);
+    remove(log);
+
+    OcrWriter writer;
+    CHECK(!writer.write(OcrRecord()));
+    CHECK(writer.open(jsonl, log, 5, 16));
+    const int count = 100;
+    for (int i = 0; i < count; i++)
+    {
+        OcrRecord record;
+        char source[32];
+        sprintf(source, "plate \"%d\"", i);
+        make_record(engine, source, result, record);
+        CHECK(writer.write(record));
+    }
+    writer.flush();
+    CHECK(writer.written() == count);
+    CHECK(writer.dropped() == 0);
+    writer.close();
+
+    //JSON Lines
+    FILE *file = fopen(jsonl, "r");
+    CHECK(file != NULL);
+    int lines = 0;
+    char line[65536];
+    while (file != NULL && fgets(line, sizeof(line), file) != NULL)
+    {
+        if (lines == 0)
+        {
+            const char *first = "{\"source\":\"plate \\\"0\\\"\",";
+            CHECK(strncmp(line, first, strlen(first)) == 0);
+            CHECK(strstr(line, "\"timings\":{\"gray\":") != NULL);
+        }
+        lines++;
+    }
+    if (file != NULL)
+        fclose(file);
+    CHECK(lines == count);
+
+    //Binary Log, Appended to by a Second Writer
+    CHECK(writer.open("", log));
+    OcrRecord last;
+    make_record(engine, "last", result, last);
+    CHECK(writer.write(last));
+    writer.close();
+    vector<OcrRecord> records;
+    CHECK(read_log(log, records));
+    CHECK((int)records.size() == count + 1);
+    for (size_t r = 0; r < records.size(); r++)
+    {
+        CHECK(records[r].plate == result.word);
+        CHECK(records[r].num_letters == result.num_letters);
+        for (int i = 0; i < result.num_letters; i++)
+        {
+            CHECK(records[r].counts[i] == result.chars[i].count);
+            CHECK(records[r].letters[i][0] ==
+                engine.converter(result.chars[i].top[0].index));
+            CHECK(fabs(records[r].scores[i][0] -
+                result.chars[i].top[0].norm) < 1.0 / 65535);
+        }
+    }
+    CHECK(records[7].source == "plate \"7\"");
+    CHECK(records[count].source == "last");
+    CHECK(records[count].timestamp >= records[0].timestamp);
+    remove(jsonl);
+    remove(log);
+}
+
+//Every index is visited once, by nested loops and submitted tasks too
+void test_pool()
+{
+    OcrPool pool(4, PLACE_NONE);
+    CHECK(pool.size() == 4);
+    CHECK(OcrPool::current_worker() == -1);
+
+    vector<int> visits(1000, 0);
+    pool.parallel_for(0, 1000, 0, [&](int first, int last)
+    {
+        for (int i = first; i < last; i++)
+            visits[i]++;
+    });
+    for (int i = 0; i < 1000; i++)
+        CHECK(visits[i] == 1);
+
+    //Nested Loops inside Tasks
+    const int outer = 16, inner = 200;
+    vector<int> cells(outer * inner, 0);
+    mutex lock;
+    condition_variable finished;
+    int done = 0;
+    for (int o = 0; o < outer; o++)
+    {
+        pool.submit([&, o]
+        {
+            pool.parallel_for(0, inner, 7, [&, o](int first, int last)
+            {
+                for (int i = first; i < last; i++)
+                    cells[o * inner + i] += 1;
+            });
+            lock_guard<mutex> guard(lock);
+            done++;
+            finished.notify_all();
+        });
+    }
+    {
+        unique_lock<mutex> guard(lock);
+        finished.wait(guard, [&]{ return done == outer; });
+    }
+    for (int i = 0; i < outer * inner; i++)
+        CHECK(cells[i] == 1);
+
+    int list[] = { 0, 1, 2, 3, 8, 9, 10, 11 };
+    vector<int> cpus = parse_cpulist("0-3,8-11\n");
+    CHECK(cpus == vector<int>(list, list + 8));
+    int placement;
+    CHECK(parse_placement("numa", placement) && placement == PLACE_NUMA);
+    CHECK(!parse_placement("all", placement));
+}
+
+//A pool changes where the work is done, not the results
+void test_batch_with_pool()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+
+    const char *files[] = {
+        "FileFmt_BMP_Sample_Alphabet.bmp",
+        "Arial_Sample_Hello.jpg",
+        "Arial_Sample_Numbers.jpg",
+        "Calibri_Sample_Today.jpg"
+    };
+    vector<OcrImage> images;
+    for (int i = 0; i < 4; i++)
+    {
+        OcrImage image;
+        if (load_image(string(OCR_TEST_FILES_DIR) + "/" + files[i], image))
+            images.push_back(image);
+    }
+    vector<PlateResult> serial(images.size()), pooled(images.size());
+    engine.recognize_batch(&images[0], images.size(), &serial[0]);
+
+    OcrPool pool(3, PLACE_NONE);
+    engine.set_pool(&pool);
+    engine.set_pyramid(PYRAMID_LEVELS, 0.05);
+    vector<PlateResult> coarse(images.size());
+    engine.recognize_batch(&images[0], images.size(), &coarse[0]);
+    engine.set_pyramid(1, 0);
+    engine.recognize_batch(&images[0], images.size(), &pooled[0]);
+    for (size_t p = 0; p < images.size(); p++)
+    {
+        CHECK(pooled[p].word == serial[p].word);
+        CHECK(pooled[p].num_letters == serial[p].num_letters);
+        CHECK(coarse[p].num_letters == serial[p].num_letters);
+        for (int i = 0; i < serial[p].num_letters; i++)
+        {
+            for (int t = 0; t < NUM_TEMPLATES; t++)
+                CHECK(pooled[p].scores[i][t] == serial[p].scores[i][t]);
+        }
+    }
+    engine.set_pool(NULL);
+}
+
+//The row tiles on a pool give the bytes of the column by column filters
+void test_tiled_preprocessing()
+{
+    //A Dark Text on a Light Frame with Some Gray Noise
+    OcrImage frame(1921, 1081);
+    srand(35);
+    for (int y = 0; y < frame.GetHeight(); y++)
+    {
+        for (int x = 0; x < frame.GetWidth(); x++)
+        {
+            int kind = rand() % 10;
+            if (kind < 7)
+                frame.SetRGB(x, y, 200, 200, 200);
+            else if (kind < 9)
+                frame.SetRGB(x, y, 30, 30, 30);
+            else
+                frame.SetRGB(x, y, 60 + rand() % 120, 60 + rand() % 120,
+                    60 + rand() % 120);
+        }
+    }
+
+    //Reference Grayscale, as the Filter was Written First
+    OcrImage reference = frame.Copy();
+    for (int x = 0; x < reference.GetWidth(); x++)
+    {
+        for (int y = 0; y < reference.GetHeight(); y++)
+        {
+            int red = reference.GetRed(x,y)*0.21;
+            int green = reference.GetGreen(x,y)*0.72;
+            int blue = reference.GetBlue(x,y)*0.07;
+            int lum = red + green + blue;
+            reference.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+
+    OcrPool pool(3, PLACE_NONE);
+    OcrImage serial = frame.Copy(), tiled = frame.Copy();
+    size_t bytes = frame.GetWidth() * frame.GetHeight() * 3;
+    grayscale(serial);
+    grayscale(tiled, &pool);
+    CHECK(memcmp(serial.GetData(), reference.GetData(), bytes) == 0);
+    CHECK(memcmp(tiled.GetData(), reference.GetData(), bytes) == 0);
+
+    threshold(serial, 0);
+    threshold(tiled, 0, &pool);
+    CHECK(memcmp(tiled.GetData(), serial.GetData(), bytes) == 0);
+
+    //A Dark Frame is Inverted the Same Way
+    OcrImage dark(800, 600);
+    for (int y = 0; y < 600; y++)
+    {
+        for (int x = 0; x < 800; x++)
+        {
+            int v = (x / 40 + y / 40) % 4 == 0 ? 220 : 20;
+            dark.SetRGB(x, y, v, v, v);
+        }
+    }
+    OcrImage darkTiled = dark.Copy();
+    threshold(dark, 0);
+    threshold(darkTiled, 0, &pool);
+    CHECK(memcmp(dark.GetData(), darkTiled.GetData(), 800 * 600 * 3) == 0);
+    CHECK(dark.GetRed(0, 0) == 0);
+}
+
+void test_color_plane()
+{
+    //Yellow Text on Gray, where the Blue Channel Separates them Best
+    OcrImage plate(300, 80);
+    for (int y = 0; y < 80; y++)
+    {
+        for (int x = 0; x < 300; x++)
+        {
+            if (y > 20 && y < 60 && x % 30 < 12)
+                plate.SetRGB(x, y, 255, 240, 0);
+            else
+                plate.SetRGB(x, y, 128, 128, 128);
+        }
+    }
+    OcrPool pool(3, PLACE_NONE);
+    OcrImage tiled = plate.Copy();
+    CHECK(color_plane(plate) == PLANE_BLUE);
+    CHECK(color_plane(tiled, &pool) == PLANE_BLUE);
+    CHECK(memcmp(plate.GetData(), tiled.GetData(), 300 * 80 * 3) == 0);
+    CHECK(plate.GetRed(0, 0) == 128 && plate.GetGreen(0, 0) == 128);
+    CHECK(plate.GetRed(0, 30) == 0 && plate.GetBlue(0, 30) == 0);
+
+    //Gray Images Keep their Luma, the Same as grayscale
+    OcrImage gray(300, 80);
+    for (int y = 0; y < 80; y++)
+    {
+        for (int x = 0; x < 300; x++)
+        {
+            int v = (x % 30 < 12) ? 40 : 210;
+            gray.SetRGB(x, y, v, v, v + 5);
+        }
+    }
+    OcrImage reference = gray.Copy();
+    grayscale(reference);
+    CHECK(color_plane(gray) == PLANE_LUMA);
+    CHECK(memcmp(gray.GetData(), reference.GetData(), 300 * 80 * 3) == 0);
+}
+
+//Bars standing for letters, rotated about the centre, black on white
+OcrImage tilted_bars(double degrees)
+{
+    OcrImage plate(400, 160);
+    double c = cos(degrees * M_PI / 180), s = sin(degrees * M_PI / 180);
+    for (int y = 0; y < 160; y++)
+    {
+        for (int x = 0; x < 400; x++)
+        {
+            //Point of the Straight Plate this Pixel Shows
+            double u = (x - 200) * c + (y - 80) * s + 200;
+            double v = -(x - 200) * s + (y - 80) * c + 80;
+            bool ink = u >= 60 && u < 340 && v >= 50 && v < 110 &&
+                (int)(u - 60) % 35 < 28;
+            int lum = ink ? 0 : 255;
+            plate.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    return plate;
+}
+
+void test_deskew()
+{
+    OcrImage letters[MAX_LETTERS];
+    OcrImage straight = tilted_bars(0);
+    CHECK(!deskew(straight, DESKEW_DEGREES));
+    segmentation(straight);
+    CHECK(segmentation_word(straight, letters) == 8);
+
+    //Tilted, the Columns of the Bars Overlap
+    OcrImage tilted = tilted_bars(9);
+    OcrImage uncorrected = tilted.Copy();
+    segmentation(uncorrected);
+    CHECK(segmentation_word(uncorrected, letters) < 8);
+
+    SkewEstimate skew;
+    CHECK(estimate_skew(tilted, DESKEW_DEGREES, skew));
+    CHECK(fabs(fabs(skew.angle) - 9) <= 0.5);
+    CHECK(fabs(skew.shear) <= 0.5);
+    CHECK(deskew(tilted, DESKEW_DEGREES));
+    segmentation(tilted);
+    CHECK(segmentation_word(tilted, letters) == 8);
+
+    //The Search Stays within the Limit, and a Limit of 0 does Nothing
+    OcrImage steep = tilted_bars(9);
+    CHECK(!estimate_skew(steep, 5, skew) || fabs(skew.angle) <= 5);
+    CHECK(!deskew(steep, 0));
+
+    //The Plate Stage of a Pipeline Follows the Setting
+    OcrEngine engine;
+    OcrPipeline pipeline(engine);
+    pipeline.set_source(tilted_bars(9));
+    shared_ptr<const OcrImage> deskewed = pipeline.plate();
+    CHECK(engine.set_deskew(0));
+    CHECK(pipeline.plate() != deskewed);
+    CHECK(!engine.set_deskew(MAX_SKEW + 1));
+}
+
+//Erosion or dilation of one pixel by a box, pixel by pixel
+bool naive_morph(const OcrBitmap &bitmap, int x, int y, int radiusX,
+    int radiusY, bool erosion)
+{
+    for (int j = y - radiusY; j <= y + radiusY; j++)
+    {
+        for (int i = x - radiusX; i <= x + radiusX; i++)
+        {
+            bool black = erosion;
+            if (i >= 0 && j >= 0 && i < bitmap.width && j < bitmap.height)
+                black = bitmap.bits[(size_t)j * bitmap.stride + i / 64] >>
+                    (i % 64) & 1;
+            if (black != erosion)
+                return !erosion;
+        }
+    }
+    return erosion;
+}
+
+void test_morphology()
+{
+    //Both against the Naive Box, over the Word Boundaries
+    const int widths[] = { 1, 63, 64, 65, 130 };
+    srand(7);
+    for (int w = 0; w < 5; w++)
+    {
+        OcrImage image(widths[w], 9);
+        for (int y = 0; y < 9; y++)
+        {
+            for (int x = 0; x < widths[w]; x++)
+            {
+                int lum = (rand() % 3 == 0) ? 255 : 0;
+                image.SetRGB(x, y, lum, lum, lum);
+            }
+        }
+        OcrBitmap bitmap;
+        pack_bitmap(image, bitmap);
+        for (int e = 0; e < 2; e++)
+        {
+            OcrBitmap result = bitmap;
+            if (e == 1)
+                erode(result, 2, 1);
+            else
+                dilate(result, 2, 1);
+            int wrong = 0;
+            for (int y = 0; y < 9; y++)
+            {
+                for (int x = 0; x < widths[w]; x++)
+                {
+                    bool black = result.bits[y * result.stride + x / 64] >>
+                        (x % 64) & 1;
+                    wrong += black != naive_morph(bitmap, x, y, 2, 1, e == 1);
+                }
+                //Past the Width Stays 0
+                if (widths[w] % 64 != 0)
+                    wrong += (result.bits[y * result.stride +
+                        result.stride - 1] >> (widths[w] % 64)) != 0;
+            }
+            CHECK(wrong == 0);
+        }
+        OcrImage back;
+        unpack_bitmap(bitmap, back);
+        CHECK(memcmp(back.GetData(), image.GetData(),
+            widths[w] * 9 * 3) == 0);
+    }
+
+    //Bars with Specks, and a Frame around Them
+    OcrImage plate(400, 160);
+    for (int y = 0; y < 160; y++)
+    {
+        for (int x = 0; x < 400; x++)
+        {
+            bool ink = x >= 60 && x < 340 && y >= 50 && y < 110 &&
+                (x - 60) % 35 < 28;
+            bool frame = x >= 20 && x < 380 && y >= 20 && y < 140 &&
+                (x < 24 || x >= 376 || y < 24 || y >= 136);
+            bool speck = x % 37 < 3 && y % 23 < 3 && !(x >= 20 &&
+                x < 380 && y >= 20 && y < 140);
+            int lum = (ink || frame || speck) ? 0 : 255;
+            plate.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    OcrImage letters[MAX_LETTERS];
+    OcrImage dirty = plate.Copy();
+    segmentation(dirty);
+    CHECK(segmentation_word(dirty, letters) != 8);
+
+    OcrBitmap bitmap;
+    pack_bitmap(plate, bitmap);
+    CHECK(stroke_width(bitmap) >= THICK_STROKE);
+    CHECK(clean_binary(plate) > 1);
+    CHECK(plate.GetRed(21, 21) == 255 && plate.GetRed(1, 1) == 255);
+    CHECK(plate.GetRed(70, 60) == 0);
+    segmentation(plate);
+    CHECK(segmentation_word(plate, letters) == 8);
+
+    //Letters Set a Pixel Apart are not Bridged
+    OcrImage close(100, 40);
+    for (int y = 0; y < 40; y++)
+    {
+        for (int x = 0; x < 100; x++)
+        {
+            bool ink = y >= 10 && y < 30 && x >= 10 && x < 90 &&
+                (x - 10) % 20 < 19;
+            int lum = ink ? 0 : 255;
+            close.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    clean_binary(close);
+    segmentation(close);
+    CHECK(segmentation_word(close, letters) == 4);
+
+    //The Plate Stage of a Pipeline Follows the Setting
+    OcrEngine engine;
+    OcrPipeline pipeline(engine);
+    pipeline.set_source(plate);
+    shared_ptr<const OcrImage> cleaned = pipeline.plate();
+    engine.set_cleanup(false);
+    CHECK(!engine.cleanup_enabled());
+    CHECK(pipeline.plate() != cleaned);
+}
+
+void test_multiline()
+{
+    //Four Short Bars over Five Tall Ones, Columns Overlapping
+    OcrImage plate(300, 140);
+    for (int y = 0; y < 140; y++)
+    {
+        for (int x = 0; x < 300; x++)
+        {
+            bool top = y >= 10 && y < 50 && x >= 40 && x < 260 &&
+                (x - 40) % 55 < 30;
+            bool bottom = y >= 70 && y < 130 && x >= 10 && x < 290 &&
+                (x - 10) % 56 < 40;
+            int lum = (top || bottom) ? 0 : 255;
+            plate.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    OcrImage letters[MAX_LETTERS];
+    CHECK(segmentation_word(plate, letters) == 9);
+
+    //Each Line only Holds its own Rows: a Top Letter is a Whole Bar
+    segmentation(letters[0]);
+    CHECK(letters[0].IsOk() && letters[0].GetRed(50, 50) == 0);
+
+    //Dots over a Line are not a Line of their Own
+    OcrImage dotted(300, 100);
+    for (int y = 0; y < 100; y++)
+    {
+        for (int x = 0; x < 300; x++)
+        {
+            bool stem = y >= 30 && y < 90 && x >= 10 && x < 290 &&
+                (x - 10) % 56 < 20;
+            bool dot = y >= 12 && y < 20 && x >= 10 && x < 290 &&
+                (x - 10) % 56 < 20;
+            int lum = (stem || dot) ? 0 : 255;
+            dotted.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    CHECK(segmentation_word(dotted, letters) == 5);
+    CHECK(letters[0].GetRed(10, 15) == 0 && letters[0].GetRed(10, 25) == 255);
+}
+
+//Samples change while other threads recognize, and corrections stick
+void test_online_training()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+    OcrImage image;
+    CHECK(load_image(string(OCR_TEST_FILES_DIR) + "/Arial_Sample_Today.jpg",
+        image));
+
+    //A Snapshot Stays as it was Taken
+    shared_ptr<const OcrBank> before = engine.templates();
+    long revision = engine.revision();
+    CHECK(engine.sample_count(0) == 1);
+    CHECK(engine.add_sample(0, before->samples[1]));
+    CHECK(engine.sample_count(0) == 2 && before->samples.size() == 52);
+    CHECK(engine.templates()->samples.size() == 53);
+    CHECK(engine.revision() != revision);
+    for (int i = 0; i < MAX_SAMPLES + 3; i++)
+        CHECK(engine.add_sample(0, before->samples[2]));
+    CHECK(engine.sample_count(0) == MAX_SAMPLES);
+    CHECK(engine.replace_samples(0, before->samples[0]));
+    CHECK(engine.sample_count(0) == 1);
+    CHECK(!engine.add_sample(NUM_TEMPLATES, before->samples[0]));
+
+    //A Template without Samples Never Matches
+    CHECK(engine.remove_samples(OcrEngine::template_index('T')));
+    PlateResult result;
+    engine.recognize(image, result);
+    CHECK(result.num_letters == 5 && result.word[0] != 'T');
+    CHECK(result.scores[0][OcrEngine::template_index('T')] == -1);
+    CHECK(engine.replace_samples(OcrEngine::template_index('T'),
+        before->samples[OcrEngine::template_index('T')]));
+
+    //Confirmed Readings are Learned
+    OcrImage input = image.Copy();
+    OcrImage letters[MAX_LETTERS];
+    int num_letters = engine.segment(input, letters);
+    engine.identify(letters, num_letters, result);
+    CHECK(engine.learn(letters, result, "TOD") == -1);
+    int wrong = 0;
+    for (int i = 0; i < 5; i++)
+        wrong += result.word[i] != "TODAY"[i];
+    CHECK(wrong > 0 && engine.learn(letters, result, "TODAY") == wrong);
+    engine.recognize(image, result);
+    CHECK(result.word == "TODAY");
+    CHECK(OcrEngine::template_index('e') == -1);
+    for (int i = 0; i < NUM_TEMPLATES; i++)
+        CHECK(OcrEngine::template_index(engine.converter(i)) == i);
+
+    //Updates while Another Thread Recognizes
+    atomic<bool> done(false);
+    int readings = 0, bad = 0;
+    thread reader([&]
+    {
+        while (!done || readings < 3)
+        {
+            PlateResult reading;
+            engine.recognize(image, reading);
+            bad += reading.num_letters != 5;
+            readings++;
+        }
+    });
+    for (int i = 0; i < 20; i++)
+    {
+        engine.add_sample(i % NUM_TEMPLATES, before->samples[i]);
+        engine.remove_samples((i + 7) % NUM_TEMPLATES);
+    }
+    done = true;
+    reader.join();
+    CHECK(bad == 0);
+}
+
+//The compact mode reads every plate as the default one, from a smaller
+//bank, whether the letters of the batch fit in the slots or not
+void check_compact(OcrEngine &engine, const vector<OcrImage> &images)
+{
+    vector<PlateResult> plain(images.size()), compact(images.size());
+    engine.set_compact(false);
+    engine.recognize_batch(&images[0], images.size(), &plain[0]);
+    engine.set_compact(true);
+    engine.recognize_batch(&images[0], images.size(), &compact[0]);
+    for (size_t p = 0; p < images.size(); p++)
+    {
+        CHECK(compact[p].word == plain[p].word);
+        CHECK(compact[p].num_letters == plain[p].num_letters);
+        for (int i = 0; i < plain[p].num_letters; i++)
+        {
+            CHECK(compact[p].chars[i].level == plain[p].chars[i].level);
+            for (int t = 0; t < NUM_TEMPLATES; t++)
+                CHECK(compact[p].scores[i][t] == plain[p].scores[i][t]);
+        }
+    }
+}
+
+void test_compact()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+    size_t full = engine.bank_bytes();
+    engine.set_compact(true);
+    size_t small = engine.bank_bytes();
+    printf("bank: %d KB, %d KB compact\n", (int)(full / 1024),
+        (int)(small / 1024));
+    CHECK(small * 10 < full);
+    CHECK(engine.templates()->samples.empty());
+    CHECK(engine.templates()->packed.size() == NUM_TEMPLATES);
+    engine.set_compact(false);
+    CHECK(engine.bank_bytes() == full);
+    CHECK(engine.templates()->samples.size() == NUM_TEMPLATES);
+
+    //Twelve Plates are More Letters than the Slots
+    const char *files[] = {
+        "Arial_Sample_Hello.jpg",
+        "Arial_Sample_Numbers.jpg",
+        "Calibri_Sample_Today.jpg",
+        "Arial_Sample_Alphabet_0.jpg"
+    };
+    vector<OcrImage> images;
+    for (int i = 0; i < 12; i++)
+    {
+        OcrImage image;
+        CHECK(load_image(string(OCR_TEST_FILES_DIR) + "/" + files[i % 4],
+            image));
+        images.push_back(image);
+    }
+    check_compact(engine, images);
+    engine.set_pyramid(PYRAMID_LEVELS, 0.05);
+    check_compact(engine, images);
+    engine.set_pyramid(1, 0);
+    engine.set_matcher(MATCH_CHAMFER);
+    check_compact(engine, images);
+    CHECK(!engine.templates()->models[0].dist.empty());
+    engine.set_matcher(MATCH_PIXELS);
+    CHECK(engine.templates()->models[0].dist.empty());
+
+    //Samples Change the Same Way
+    CHECK(engine.add_sample(0, images[0]));
+    CHECK(engine.replace_samples(1, images[1]));
+    CHECK(engine.sample_count(0) == 2 && engine.sample_count(1) == 1);
+    CHECK(engine.templates()->packed.size() == NUM_TEMPLATES + 1);
+    CHECK(engine.remove_samples(0));
+    check_compact(engine, images);
+
+    //Images that cannot be Loaded Read Nothing
+    PlateResult results[3];
+    engine.recognize_stream(3, [&](int index, OcrImage &image)
+    {
+        if (index == 1)
+            return false;
+        image = images[index].Copy();
+        return true;
+    }, results);
+    CHECK(results[0].num_letters == 5);
+    CHECK(results[1].num_letters == 0 && results[1].word.empty());
+    CHECK(results[2].num_letters == 5);
+    CHECK(peak_memory_kb() != 0);
+}
+
+//Percentiles are kept to three digits, from microseconds to minutes
+void test_histogram()
+{
+    OcrHistogram empty;
+    CHECK(empty.count() == 0 && empty.percentile(99) == 0);
+
+    OcrHistogram low, high, all;
+    for (int64_t v = 1; v <= 100000; v++)
+    {
+        all.record(v);
+        if (v <= 50000)
+            low.record(v);
+        else
+            high.record(v);
+    }
+    CHECK(all.count() == 100000);
+    CHECK(all.min() == 1 && all.max() == 100000);
+    CHECK(fabs(all.mean() - 50000.5) < 1e-6);
+    int64_t percents[] = {50, 90, 99};
+    for (int i = 0; i < 3; i++)
+    {
+        int64_t exact = percents[i] * 1000;
+        int64_t kept = all.percentile((double)percents[i]);
+        CHECK(kept >= exact && kept <= exact + exact / 1000);
+    }
+    CHECK(all.percentile(100) == 100000);
+
+    //Merging the Halves gives the Whole
+    low.merge(high);
+    CHECK(low.count() == all.count());
+    CHECK(low.min() == 1 && low.max() == 100000);
+    CHECK(low.percentile(99.9) == all.percentile(99.9));
+
+    //Small Values are Exact, Large Ones Clamped
+    OcrHistogram clamped(60000000);
+    clamped.record(7);
+    clamped.record(-5);
+    clamped.record(90000000);
+    CHECK(clamped.percentile(30) == 0);
+    CHECK(clamped.percentile(50) == 7);
+    CHECK(clamped.max() == 60000000);
+    clamped.reset();
+    CHECK(clamped.count() == 0);
+}
+
+//The glyphs made from windows of the plate are those of the letters
+//copied out by segmentation_word
+void check_letter_views(const OcrImage &plate)
+{
+    OcrImage copied[MAX_LETTERS];
+    OcrView windows[MAX_LETTERS];
+    OcrImage input = plate.Copy();
+    int num_letters = segmentation_word(input, copied);
+    CHECK(segment_letters(plate, windows) == num_letters);
+    int sizes[] = {GLYPH_SMALL, GLYPH_MEDIUM, GLYPH_LARGE, 17};
+    for (int a = 0; a < num_letters; a++)
+    {
+        OcrImage cropped = copied[a].Copy();
+        segmentation(cropped);
+        CHECK(windows[a].GetHeight() <= plate.GetHeight());
+        for (int s = 0; s < 4; s++)
+        {
+            OcrImage expected = cropped.Copy(), glyph;
+            rescale_glyph(expected, sizes[s]);
+            normalize_glyph(windows[a], sizes[s], glyph);
+            CHECK(glyph.GetWidth() == sizes[s] &&
+                glyph.GetHeight() == sizes[s]);
+            CHECK(memcmp(glyph.GetData(), expected.GetData(),
+                sizes[s] * sizes[s] * 3) == 0);
+        }
+    }
+}
+
+void test_letter_views()
+{
+    //Windows Point into the Image
+    OcrImage image(40, 30);
+    image.SetRGB(12, 7, 1, 2, 3);
+    OcrView view(image, 10, 5, 20, 10);
+    CHECK(view.IsOk() && view.GetWidth() == 20 && view.GetHeight() == 10);
+    CHECK(view.GetRed(2, 2) == 1 && view.GetRow(2)[8] == 3);
+    CHECK(view.Window(2, 2, 1, 1).GetRed(0, 0) == 1);
+    CHECK(!view.Window(15, 0, 10, 10).IsOk());
+    OcrImage copy = view.Copy();
+    CHECK(copy.GetWidth() == 20 && copy.GetGreen(2, 2) == 2);
+    OcrImage scaled = view.Scale(7, 9);
+    OcrImage expected = copy.Scale(7, 9);
+    CHECK(memcmp(scaled.GetData(), expected.GetData(), 7 * 9 * 3) == 0);
+
+    //Plates of the Samples
+    OcrEngine engine;
+    const char *files[] = {
+        "Arial_Sample_Hello.jpg",
+        "Arial_Sample_Numbers.jpg",
+        "Calibri_Sample_Today.jpg",
+        "Arial_Sample_Alphabet_0.jpg"
+    };
+    for (int i = 0; i < 4; i++)
+    {
+        OcrImage plate;
+        CHECK(load_image(string(OCR_TEST_FILES_DIR) + "/" + files[i],
+            plate));
+        engine.to_gray(plate);
+        engine.to_binary(plate);
+        OcrImage frame = plate.Copy();
+        engine.crop_plate(plate);
+        check_letter_views(plate);
+
+        //The Window of the Plate is what crop_plate Copies
+        OcrView window = engine.find_plate(frame);
+        CHECK(window.GetWidth() == plate.GetWidth() &&
+            window.GetHeight() == plate.GetHeight());
+        for (int y = 0; y < plate.GetHeight(); y++)
+            CHECK(memcmp(window.GetRow(y), OcrView(plate).GetRow(y),
+                plate.GetWidth() * 3) == 0);
+        OcrView letters[MAX_LETTERS], copied[MAX_LETTERS];
+        int num_letters = segment_letters(window, letters);
+        CHECK(segment_letters(plate, copied) == num_letters);
+        for (int a = 0; a < num_letters; a++)
+        {
+            OcrImage glyph, expected;
+            normalize_glyph(letters[a], GLYPH_LARGE, glyph);
+            normalize_glyph(copied[a], GLYPH_LARGE, expected);
+            CHECK(memcmp(glyph.GetData(), expected.GetData(),
+                GLYPH_LARGE * GLYPH_LARGE * 3) == 0);
+        }
+    }
+
+    //Two Lines, and Letters that Fill their Window
+    OcrImage lines(300, 140);
+    for (int y = 0; y < 140; y++)
+    {
+        for (int x = 0; x < 300; x++)
+        {
+            bool top = y >= 10 && y < 50 && x >= 40 && x < 260 &&
+                (x - 40) % 55 < 30;
+            bool bottom = y >= 70 && y < 130 && x >= 10 && x < 290 &&
+                (x - 10) % 56 < 40;
+            int lum = (top || bottom) ? 0 : 255;
+            lines.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    check_letter_views(lines);
+    OcrImage bars(90, 40);
+    for (int y = 0; y < 40; y++)
+    {
+        for (int x = 0; x < 90; x++)
+        {
+            int lum = (x % 30 < 20) ? 0 : 255;
+            bars.SetRGB(x, y, lum, lum / 2, lum / 3);
+        }
+    }
+    check_letter_views(bars);
+}
+
+//A 3x3 box blur of an image, edges clamped
+OcrImage box_blur(const OcrImage &image)
+{
+    int w = image.GetWidth(), h = image.GetHeight();
+    OcrImage blurred(w, h);
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            int sum[3] = {0, 0, 0};
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int sx = min(max(x + dx, 0), w - 1);
+                    int sy = min(max(y + dy, 0), h - 1);
+                    sum[0] += image.GetRed(sx, sy);
+                    sum[1] += image.GetGreen(sx, sy);
+                    sum[2] += image.GetBlue(sx, sy);
+                }
+            }
+            blurred.SetRGB(x, y, sum[0] / 9, sum[1] / 9, sum[2] / 9);
+        }
+    }
+    return blurred;
+}
+
+void test_quality_gate()
+{
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+    const char *files[] = {
+        "Arial_Sample_Hello.jpg",
+        "Arial_Sample_Numbers.jpg",
+        "Calibri_Sample_Today.jpg"
+    };
+    for (int i = 0; i < 3; i++)
+    {
+        OcrImage image;
+        CHECK(load_image(string(OCR_TEST_FILES_DIR) + "/" + files[i],
+            image));
+
+        //The Color Frame is Measured, Sharp, and Sharper than Blurred
+        FrameQuality quality, blurred;
+        frame_quality(image, quality);
+        frame_quality(box_blur(image), blurred);
+        CHECK(quality.sharpness >= GATE_SHARPNESS);
+        CHECK(quality.spread >= GATE_SPREAD);
+        CHECK(blurred.sharpness < GATE_SHARPNESS);
+
+        //A Sharp Sample Passes with the Reading of the Ungated Engine
+        PlateResult plain, gated;
+        engine.recognize(image, plain);
+        engine.set_gate(true);
+        engine.recognize(image, gated);
+        CHECK(gated.rejected == GATE_PASSED);
+        CHECK(gated.word == plain.word && gated.num_letters > 1);
+
+        //Blurred, and too Many Letters
+        engine.recognize(box_blur(image), gated);
+        CHECK(gated.rejected == GATE_BLURRED && gated.num_letters == 0);
+        CHECK(gated.timings[STAGE_BINARY] == 0);
+        GateOptions options;
+        options.max_letters = 1;
+        engine.set_gate(true, options);
+        engine.recognize(image, gated);
+        CHECK(gated.rejected == GATE_LETTERS && gated.word.empty());
+        engine.set_gate(false);
+    }
+
+    //A Flat Frame, Sharp Noise of a Few Levels
+    OcrImage flat(200, 60);
+    srand(9);
+    for (int y = 0; y < 60; y++)
+    {
+        for (int x = 0; x < 200; x++)
+        {
+            int lum = 120 + (rand() % 5) * 2;
+            flat.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    PlateResult result;
+    engine.set_gate(true);
+    engine.recognize(flat, result);
+    CHECK(result.rejected == GATE_FLAT && result.num_letters == 0);
+    CHECK(strcmp(gate_names[GATE_FLAT], "flat") == 0);
+
+    //So Small a Frame that Fewer than 100 Pixels are Sampled
+    OcrImage small(30, 30);
+    for (int y = 0; y < 30; y++)
+    {
+        for (int x = 0; x < 30; x++)
+        {
+            int lum = 120 + rand() % 9;
+            small.SetRGB(x, y, lum, lum, lum);
+        }
+    }
+    FrameQuality quality;
+    frame_quality(small, quality);
+    CHECK(quality.spread > 0 && quality.spread <= 8);
+    engine.recognize(small, result);
+    CHECK(result.rejected == GATE_FLAT);
+    engine.set_gate(false);
+    CHECK(!engine.gate_enabled());
+}
+
+//A reading of word whose every letter matched with score norm, ahead of
+//rival (if any) with the confidence given
+PlateResult fusion_frame(const char *word, double norm, char rival = 0,
+    double confidence = 1)
+{
+    PlateResult result;
+    result.word = word;
+    result.num_letters = strlen(word);
+    for (int i = 0; i < result.num_letters; i++)
+    {
+        CharResult &letter = result.chars[i];
+        letter.count = rival ? 2 : 1;
+        letter.confidence = confidence;
+        letter.top[0].index = OcrEngine::template_index(word[i]);
+        letter.top[0].score = (int)(norm * 10000);
+        letter.top[0].norm = norm;
+        letter.top[1].index = OcrEngine::template_index(rival);
+        letter.top[1].score = letter.top[0].score;
+        letter.top[1].norm = norm;
+    }
+    return result;
+}
+
+void test_fusion()
+{
+    //Votes per Position, Weighted by the Match Scores
+    OcrTrack track;
+    track.add(fusion_frame("ABC123", 0.9));
+    track.add(fusion_frame("A8C123", 0.9));
+    track.add(fusion_frame("ABC123", 0.9));
+    CHECK(track.word() == "ABC123" && track.frames() == 3);
+    track.reset();
+    track.add(fusion_frame("ABD", 0.5));
+    track.add(fusion_frame("ABC", 0.9));
+    CHECK(track.word() == "ABC" && track.confidence() < 0.5);
+
+    //Missed and Extra Letters are Aligned
+    track.reset();
+    track.add(fusion_frame("ABC234", 0.9));
+    track.add(fusion_frame("ABC1234", 0.8));
+    track.add(fusion_frame("ABCX1234", 0.9));
+    track.add(fusion_frame("ABC1234", 0.8));
+    CHECK(track.word() == "ABC1234");
+
+    //Decided Once the Consensus is Clear Enough
+    track.reset();
+    int frames = 0;
+    while (!track.add(fusion_frame("XYZ789", 0.9)))
+        frames++;
+    CHECK(frames == 3 && track.frames() == 4);
+    CHECK(track.confidence() >= FUSION_CONFIDENCE);
+    OcrTrack split;
+    for (int i = 0; i < 4; i++)
+        split.add(fusion_frame(i % 2 ? "XYZ789" : "XYZ788", 0.9));
+    CHECK(!split.decided() && split.confidence() < 0.1);
+
+    //Coin Flips Never Settle, however Many Frames Agree on them
+    OcrTrack flips;
+    while (!flips.add(fusion_frame("OOO", 0.9, '0', 0.02)))
+        ;
+    CHECK(flips.frames() == FUSION_FRAMES && flips.word() == "OOO");
+    CHECK(flips.confidence() < 0.1);
+    track.reset();
+    for (int i = 0; i < 6; i++)
+        track.add(fusion_frame("OOO", 0.9, '0', 0.9));
+    CHECK(track.decided() && track.word() == "OOO");
+
+    //Skipped Frames Vote for Nothing, but a Track Ends all the Same
+    OcrTrack brief(0.99, 3);
+    PlateResult skipped = fusion_frame("QQQ", 0.9);
+    skipped.rejected = GATE_BLURRED;
+    CHECK(!brief.add(skipped) && !brief.add(PlateResult()));
+    CHECK(brief.word().empty() && brief.confidence() == 0);
+    CHECK(brief.add(fusion_frame("ABC", 0.9)) && brief.word() == "ABC");
+
+    //Frames of a Sample
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+    OcrImage image;
+    CHECK(load_image(string(OCR_TEST_FILES_DIR) + "/Calibri_Sample_Hello.jpg",
+        image));
+    PlateResult result;
+    engine.recognize(image, result);
+    track.reset();
+    while (!track.add(result))
+        engine.recognize(image, result);
+    //Its Letters are Close Calls, which Frames of the Same Image do not
+    //Settle: the Track Runs to the Last Frame, Less Sure than Any
+    CHECK(track.word() == result.word && track.frames() == FUSION_FRAMES);
+    CHECK(track.confidence() <= result.confidence);
+}
+
+int main()
+{
+    test_batch_kernels();
+    test_rescale_glyph();
+    test_pack_bits_scaled();
+    test_top_candidates();
+    test_recognize();
+    test_glyph_sizes();
+    test_pyramid();
+    test_pipeline();
+    test_writer();
+    test_pool();
+    test_batch_with_pool();
+    test_tiled_preprocessing();
+    test_color_plane();
+    test_deskew();
+    test_morphology();
+    test_multiline();
+    test_online_training();
+    test_compact();
+    test_histogram();
+    test_letter_views();
+    test_quality_gate();
+    test_fusion();
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,356 @@
+/***************************************************************
+ * Name:      ocrTestFuzz.cpp
+ * Purpose:   Random Inputs for the Stages and the Kernels, meant
+ *            to be Run under AddressSanitizer and UBSan
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <random>
+#include <fstream>
+#include <iterator>
+#include "ocrAppEngine.h"
+#include "ocrAppPrepro.h"
+#include "ocrImageIO.h"
+#include "PerspectiveTransform.h"
+#include "ocrTest.h"
+
+using namespace std;
+
+/*
+* Every iteration makes a random image (blank, noise, bars, blocks of
+* "letters" or stripes) and runs it through the whole recognition, and
+* checks the optimized kernels against their scalar references on random
+* sizes: the batch matching kernels against match_scores, the fixed-size
+* rescale against OcrImage::Scale, the scaled packing against rescaling
+* and packing, and the tiled filters against a single pass. Corrupted
+* image files and degenerate perspective matrices are thrown at the
+* loaders and the transform too.
+*
+*   ocrTestFuzz [iterations] [seed]
+*
+* The checks find wrong results; reads out of bounds, leaks and undefined
+* behaviour are found by building with OCR_SANITIZE.
+*/
+
+//Functions
+OcrImage random_image(mt19937 &random);
+void check_recognition(const OcrEngine &engine, const OcrImage &image);
+void check_kernels(mt19937 &random);
+void check_rescale(mt19937 &random);
+void check_filters(mt19937 &random, OcrPool &pool);
+void check_loaders(mt19937 &random, const vector<unsigned char> &file);
+void check_transform(mt19937 &random);
+void check_many_letters(const OcrEngine &engine);
+vector<unsigned char> read_file(const string &filename);
+
+int main(int argc, char **argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+    unsigned seed = (argc > 2) ? strtoul(argv[2], NULL, 10) : 39;
+    mt19937 random(seed);
+
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+    OcrPool pool(3, PLACE_NONE);
+
+    //Samples the Corruptions Start From
+    const char *files[] = {
+        "FileFmt_BMP_Sample_Alphabet.bmp",
+        "FileFmt_PNG_Sample_Alphabet.png",
+        "Arial_Sample_Hello.jpg"
+    };
+    vector< vector<unsigned char> > samples;
+    for (int f = 0; f < 3; f++)
+    {
+        samples.push_back(read_file(string(OCR_TEST_FILES_DIR) + "/" +
+            files[f]));
+        CHECK(!samples.back().empty());
+    }
+
+    check_many_letters(engine);
+    for (int it = 0; it < iterations; it++)
+    {
+        OcrImage image = random_image(random);
+        check_recognition(engine, image);
+        check_kernels(random);
+        check_rescale(random);
+        check_filters(random, pool);
+        check_loaders(random, samples[it % 3]);
+        check_transform(random);
+
+        //The Other Matcher and a Pyramid Now and Then
+        if (it % 8 == 0)
+        {
+            OcrEngine &other = engine;
+            other.set_matcher(MATCH_CHAMFER);
+            check_recognition(other, image);
+            other.set_matcher(MATCH_PIXELS);
+            other.set_pyramid(PYRAMID_LEVELS, 0.05);
+            check_recognition(other, image);
+            other.set_pyramid(1, 0);
+        }
+    }
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed (seed %u)\n", failures, seed);
+        return 1;
+    }
+    printf("%d iterations passed (seed %u)\n", iterations, seed);
+    return 0;
+}
+
+OcrImage random_image(mt19937 &random)
+{
+    int width = 1 + random() % 320;
+    int height = 1 + random() % 160;
+    OcrImage image(width, height);
+    unsigned char *data = image.GetData();
+    int kind = random() % 5;
+    int paper = (random() & 1) ? 255 : 0;
+    memset(data, paper, width * height * 3);
+
+    if (kind == 1)
+    {
+        //Noise
+        for (int i = 0; i < width * height * 3; i++)
+            data[i] = random();
+    }
+    else if (kind == 2 || kind == 3)
+    {
+        //Blocks or Bars of Ink
+        int blocks = random() % 60;
+        for (int b = 0; b < blocks; b++)
+        {
+            int x = random() % width, y = random() % height;
+            int w = 1 + random() % (kind == 2 ? 20 : 3);
+            int h = (kind == 2) ? 1 + random() % height : height;
+            int ink = random() % 256;
+            for (int j = y; j < y + h && j < height; j++)
+            {
+                for (int i = x; i < x + w && i < width; i++)
+                {
+                    unsigned char *pixel = data + (j * width + i) * 3;
+                    pixel[0] = pixel[1] = pixel[2] = ink;
+                }
+            }
+        }
+    }
+    else if (kind == 4)
+    {
+        //Single Pixels
+        int dots = random() % 8;
+        for (int d = 0; d < dots; d++)
+        {
+            unsigned char *pixel =
+                data + (random() % (width * height)) * 3;
+            pixel[0] = pixel[1] = pixel[2] = 255 - paper;
+        }
+    }
+    return image;
+}
+
+//Whatever the image, the reading is consistent and within its arrays
+void check_recognition(const OcrEngine &engine, const OcrImage &image)
+{
+    PlateResult result;
+    engine.recognize(image, result);
+    CHECK(result.num_letters >= 0 && result.num_letters <= MAX_LETTERS);
+    CHECK((int)result.word.size() == result.num_letters);
+    CHECK(!isnan(result.confidence));
+    for (int i = 0; i < result.num_letters; i++)
+    {
+        CHECK(result.chars[i].count >= 0 && result.chars[i].count <= TOP_K);
+        CHECK(result.chars[i].confidence >= 0 &&
+            result.chars[i].confidence <= 1);
+    }
+}
+
+//Every batch kernel against match_scores, on sizes of every kind
+void check_kernels(mt19937 &random)
+{
+    int size = 4 + random() % 120;
+    int numPixels = size * size;
+    int numGlyphs = 1 + random() % 9;
+    int numTemplates = (random() & 1) ? NUM_TEMPLATES : 1 + random() % 80;
+    int words = WORDS_FOR(numPixels);
+
+    vector<unsigned char> glyphs(numGlyphs * numPixels * 3);
+    vector<unsigned char> temps(numTemplates * numPixels * 3);
+    for (size_t i = 0; i < glyphs.size(); i += 3)
+        glyphs[i] = glyphs[i + 1] = glyphs[i + 2] = (random() & 1) ? 255 : 0;
+    for (size_t i = 0; i < temps.size(); i += 3)
+        temps[i] = temps[i + 1] = temps[i + 2] = (random() & 1) ? 255 : 0;
+
+    vector<uint64_t> glyphbits(numGlyphs * words);
+    vector<uint64_t> tempbits(numTemplates * words);
+    vector<const unsigned char *> templates(numTemplates);
+    for (int g = 0; g < numGlyphs; g++)
+        pack_bits(&glyphs[g * numPixels * 3], numPixels, &glyphbits[g * words]);
+    for (int t = 0; t < numTemplates; t++)
+    {
+        pack_bits(&temps[t * numPixels * 3], numPixels, &tempbits[t * words]);
+        templates[t] = &temps[t * numPixels * 3];
+    }
+
+    vector<int> expected(numGlyphs * numTemplates);
+    for (int g = 0; g < numGlyphs; g++)
+    {
+        match_scores(&glyphs[g * numPixels * 3], &templates[0],
+            numTemplates, numPixels, &expected[g * numTemplates]);
+    }
+    const char *kernels[] = { "generic", "popcnt", "avx512" };
+    for (int k = 0; k < 3; k++)
+    {
+        if (!use_batch_kernel(kernels[k]))
+            continue;
+        vector<int> stat(numGlyphs * numTemplates, -1);
+        match_scores_batch(&glyphbits[0], numGlyphs, &tempbits[0],
+            numTemplates, numPixels, &stat[0]);
+        CHECK(stat == expected);
+    }
+}
+
+//rescale_glyph and pack_bits_scaled give the pixels of OcrImage::Scale
+void check_rescale(mt19937 &random)
+{
+    OcrImage letter(1 + random() % 400, 1 + random() % 400);
+    unsigned char *data = letter.GetData();
+    for (int i = 0; i < letter.GetWidth() * letter.GetHeight(); i++)
+        data[i * 3] = data[i * 3 + 1] = data[i * 3 + 2] =
+            (random() & 1) ? 255 : 0;
+
+    const int sizes[] = { GLYPH_SMALL, GLYPH_MEDIUM, GLYPH_LARGE,
+        GLYPH_LARGE / 2, GLYPH_LARGE / 4, 8 + (int)(random() % 120) };
+    for (int s = 0; s < 6; s++)
+    {
+        int size = sizes[s];
+        OcrImage fixed = letter.Copy();
+        rescale_glyph(fixed, size);
+        OcrImage scaled = letter.Scale(size, size);
+        CHECK(fixed.GetWidth() == size && fixed.GetHeight() == size);
+        CHECK(memcmp(fixed.GetData(), scaled.GetData(),
+            size * size * 3) == 0);
+
+        for (int l = 1; l < PYRAMID_LEVELS; l++)
+        {
+            int lsize = PYRAMID_SIZE(size, l);
+            int words = WORDS_FOR(lsize * lsize);
+            OcrImage coarse = fixed.Copy();
+            rescale_glyph(coarse, lsize);
+            vector<uint64_t> reference(words), bits(words, ~0ULL);
+            pack_bits(coarse.GetData(), lsize * lsize, &reference[0]);
+            pack_bits_scaled(fixed.GetData(), size, lsize, &bits[0]);
+            CHECK(bits == reference);
+        }
+    }
+}
+
+//The row tiles on the pool give the bytes of a single pass
+void check_filters(mt19937 &random, OcrPool &pool)
+{
+    OcrImage frame(1 + random() % 1200, 1 + random() % 300);
+    unsigned char *data = frame.GetData();
+    for (int i = 0; i < frame.GetWidth() * frame.GetHeight() * 3; i++)
+        data[i] = (random() % 4 == 0) ? random() : 200;
+    size_t bytes = frame.GetWidth() * frame.GetHeight() * 3;
+
+    OcrImage serial = frame.Copy(), tiled = frame.Copy();
+    grayscale(serial);
+    grayscale(tiled, &pool);
+    CHECK(memcmp(serial.GetData(), tiled.GetData(), bytes) == 0);
+    OcrImage planeSerial = frame.Copy(), planeTiled = frame.Copy();
+    CHECK(color_plane(planeSerial) == color_plane(planeTiled, &pool));
+    CHECK(memcmp(planeSerial.GetData(), planeTiled.GetData(), bytes) == 0);
+    int thr = threshold(serial, 0);
+    CHECK(threshold(tiled, 0, &pool) == thr);
+    CHECK(thr >= 0 && thr <= 255);
+    CHECK(memcmp(serial.GetData(), tiled.GetData(), bytes) == 0);
+}
+
+//Corrupted and truncated files are refused or read, never overrun
+void check_loaders(mt19937 &random, const vector<unsigned char> &file)
+{
+    if (file.empty())
+        return;
+    vector<unsigned char> bytes = file;
+    int flips = random() % 16;
+    for (int f = 0; f < flips; f++)
+        bytes[random() % bytes.size()] = random();
+    if (random() & 1)
+        bytes.resize(random() % bytes.size());
+
+    OcrImage image;
+    const unsigned char *start = bytes.empty() ? NULL : &bytes[0];
+    if (load_image_memory(start, bytes.size(), image))
+        CHECK(image.IsOk());
+}
+
+//Any matrix, degenerate ones included, maps pixels inside the array
+void check_transform(mt19937 &random)
+{
+    int width = 1 + random() % 64, height = 1 + random() % 64;
+    vector<int> pixels(width * height);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = 2 + random() % 5;
+
+    uniform_real_distribution<double> value(-2, 2);
+    double m[9];
+    for (int i = 0; i < 9; i++)
+        m[i] = (random() % 4 == 0) ? 0 : value(random);
+    PerspectiveTransform transform(m[0], m[1], m[2], m[3], m[4], m[5],
+        m[6], m[7], m[8]);
+    vector<int> result = transform.transformPoints(pixels, width, height);
+    CHECK((int)result.size() == width * height);
+    for (size_t i = 0; i < result.size(); i++)
+        CHECK(result[i] == 1 || (result[i] >= 2 && result[i] <= 6));
+}
+
+//More columns of ink than there is room for letters
+void check_many_letters(const OcrEngine &engine)
+{
+    OcrImage stripes(4 * (MAX_LETTERS + 30), 40);
+    unsigned char *data = stripes.GetData();
+    memset(data, 255, stripes.GetWidth() * stripes.GetHeight() * 3);
+    for (int y = 0; y < stripes.GetHeight(); y++)
+    {
+        for (int x = 0; x < stripes.GetWidth(); x += 4)
+        {
+            unsigned char *pixel = data + (y * stripes.GetWidth() + x) * 3;
+            pixel[0] = pixel[1] = pixel[2] = 0;
+        }
+    }
+    OcrImage plate = stripes.Copy();
+    OcrImage letters[MAX_LETTERS];
+    grayscale(plate);
+    threshold(plate, 0);
+    segmentation(plate);
+    CHECK(segmentation_word(plate, letters) == MAX_LETTERS);
+    check_recognition(engine, stripes);
+
+    //Blank Images have no Letters
+    OcrImage white(50, 20), black(1, 1);
+    memset(white.GetData(), 255, 50 * 20 * 3);
+    PlateResult result;
+    engine.recognize(white, result);
+    CHECK(result.num_letters == 0);
+    engine.recognize(black, result);
+    CHECK(result.num_letters == 0);
+}
+
+//Supplementary Code
+vector<unsigned char> read_file(const string &filename)
+{
+    ifstream file(filename.c_str(), ios::binary);
+    return vector<unsigned char>((istreambuf_iterator<char>(file)),
+        istreambuf_iterator<char>());
+}
@@ -0,0 +1,202 @@
+/***************************************************************
+ * Name:      ocrTestGolden.cpp
+ * Purpose:   Golden Outputs of every Stage for the Sample Images
+ * Author:
+ * Created:   2026-10-19
+ * Copyright:
+ * License:
+ **************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <fstream>
+#include "ocrAppEngine.h"
+#include "ocrAppPrepro.h"
+#include "ocrImageIO.h"
+#include "ocrTest.h"
+
+using namespace std;
+
+/*
+* Every sample of test_files is run through the stages one by one and
+* described by a single line of tests/golden/samples.txt:
+*
+*   <file> plane=<projection> threshold=<t> binary=<hash> plate=<w>x<h>
+*       letters=<n> boxes=<w>x<h>,... pixels=<word> chamfer=<word>
+*
+* plane is the projection color_plane chose, binary is a hash of the
+* thresholded image, plate is the size of what crop_plate left of it
+* (cleaned, straightened and cropped), boxes are the letters as cropped
+* after segmentation_word, and the words are those of the pixel and the
+* chamfer matchers. A file the core cannot read is "unsupported".
+*
+* Any change to a stage shows up as a changed line. When the change is
+* meant (or the JPEG decoder is another version), the file is written
+* again with --update and the difference is reviewed with the change.
+*/
+
+//Samples, as found in test_files
+const char *samples[] =
+{
+    "Arial-Bold_Sample_Alphabet_0.jpg",
+    "Arial-Bold_Sample_Alphabet_1.jpg",
+    "Arial-Bold_Sample_Alphabet_2.jpg",
+    "Arial-Bold_Sample_Alphabet_3.jpg",
+    "Arial_Sample_Alphabet_0.jpg",
+    "Arial_Sample_Alphabet_1.jpg",
+    "Arial_Sample_Alphabet_2.jpg",
+    "Arial_Sample_Alphabet_3.jpg",
+    "Arial_Sample_Alphabet_Blue.jpg",
+    "Arial_Sample_Alphabet_ColorBg.jpg",
+    "Arial_Sample_Alphabet_White_on_Black.jpg",
+    "Arial_Sample_Hello.jpg",
+    "Arial_Sample_Hello_lowercase.jpg",
+    "Arial_Sample_Numbers.jpg",
+    "Arial_Sample_Today.jpg",
+    "Calibri_Sample_Alphabet.jpg",
+    "Calibri_Sample_Alphabet_1.jpg",
+    "Calibri_Sample_Alphabet_2.jpg",
+    "Calibri_Sample_Alphabet_3.jpg",
+    "Calibri_Sample_Hello.jpg",
+    "Calibri_Sample_Today.jpg",
+    "FileFmt_BMP_Sample_Alphabet.bmp",
+    "FileFmt_GIF_Sample_Alphabet.gif",
+    "FileFmt_JPEG_Sample_Alphabet.jpg",
+    "FileFmt_PNG_Sample_Alphabet.png"
+};
+#define NUM_SAMPLES (int)(sizeof(samples) / sizeof(samples[0]))
+
+//Functions
+string describe(OcrEngine &engine, const char *file);
+uint64_t image_hash(const OcrImage &image);
+bool always_readable(const string &file);
+
+int main(int argc, char **argv)
+{
+    bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+
+    OcrEngine engine;
+    CHECK(engine.train(OCR_TRAINSET_DIR));
+
+    //Golden Lines by File
+    map<string, string> golden;
+    ifstream in(OCR_GOLDEN_FILE);
+    string line;
+    while (getline(in, line))
+    {
+        if (!line.empty() && line[0] != '#')
+            golden[line.substr(0, line.find(' '))] = line;
+    }
+    in.close();
+    if (!update)
+        CHECK(golden.size() == (size_t)NUM_SAMPLES);
+
+    stringstream out;
+    out << "# Written by ocrTestGolden --update, see tests/ocrTestGolden.cpp\n";
+    for (int i = 0; i < NUM_SAMPLES; i++)
+    {
+        string found = describe(engine, samples[i]);
+        out << found << "\n";
+        if (update)
+            continue;
+
+        //Decoders Missing from the Build are Skipped
+        string expected = golden[samples[i]];
+        if (found == string(samples[i]) + " unsupported" &&
+            expected != found && !always_readable(samples[i]))
+        {
+            printf("%s: skipped, not readable by this build\n", samples[i]);
+            continue;
+        }
+        if (found != expected)
+        {
+            fprintf(stderr, "expected: %s\n   found: %s\n",
+                expected.c_str(), found.c_str());
+            failures++;
+        }
+    }
+
+    if (update)
+    {
+        ofstream file(OCR_GOLDEN_FILE);
+        file << out.str();
+        printf("wrote %s\n", OCR_GOLDEN_FILE);
+        return file.good() ? 0 : 1;
+    }
+    if (failures > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all %d samples match\n", NUM_SAMPLES);
+    return 0;
+}
+
+//The stages of OcrEngine::segment, one at a time, then both matchers
+string describe(OcrEngine &engine, const char *file)
+{
+    stringstream line;
+    line << file;
+    OcrImage image;
+    if (!load_image(string(OCR_TEST_FILES_DIR) + "/" + file, image))
+    {
+        line << " unsupported";
+        return line.str();
+    }
+
+    OcrImage plate = image.Copy();
+    int plane = color_plane(plate);
+    int thr = threshold(plate, 0);
+    char hash[20];
+    sprintf(hash, "%016llx", (unsigned long long)image_hash(plate));
+    line << " plane=" << plane_names[plane] << " threshold=" << thr
+         << " binary=" << hash;
+
+    engine.crop_plate(plate);
+    line << " plate=" << plate.GetWidth() << "x" << plate.GetHeight();
+
+    OcrImage letters[MAX_LETTERS];
+    int num_letters = segmentation_word(plate, letters);
+    line << " letters=" << num_letters << " boxes=";
+    for (int i = 0; i < num_letters; i++)
+    {
+        segmentation(letters[i]);
+        line << (i > 0 ? "," : "") << letters[i].GetWidth() << "x"
+             << letters[i].GetHeight();
+    }
+
+    PlateResult result;
+    engine.set_matcher(MATCH_PIXELS);
+    engine.recognize(image, result);
+    line << " pixels=" << result.word;
+    engine.set_matcher(MATCH_CHAMFER);
+    engine.recognize(image, result);
+    line << " chamfer=" << result.word;
+    engine.set_matcher(MATCH_PIXELS);
+    return line.str();
+}
+
+//Supplementary Code
+//FNV-1a of the size and the pixels
+uint64_t image_hash(const OcrImage &image)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    int size[2] = { image.GetWidth(), image.GetHeight() };
+    const unsigned char *bytes = (const unsigned char *)size;
+    for (size_t i = 0; i < sizeof(size); i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    bytes = image.GetData();
+    for (int i = 0; i < image.GetWidth() * image.GetHeight() * 3; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+//BMP is read by the core itself, whatever libraries the build found
+bool always_readable(const string &file)
+{
+    return file.size() > 4 && file.compare(file.size() - 4, 4, ".bmp") == 0;
+}